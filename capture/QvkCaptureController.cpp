@@ -0,0 +1,329 @@
+#include "QvkCaptureController.h"
+
+#include <QDebug>
+
+QvkCaptureController::QvkCaptureController( QvkEncoderPool *pool, QvkMuxer *sharedMuxer )
+{
+  qRegisterMetaType<QvkCaptureSettings>( "QvkCaptureSettings" );
+
+  running = false;
+  pausing = false;
+  lastFrameCount = 0;
+  encoderPool = pool;
+  poolSession = 0;
+
+  grabber = new QvkShmGrabber();
+  queue = new QvkFrameQueue( 8 );
+  ownMuxer = ( sharedMuxer == NULL ) ? new QvkMuxer() : NULL;
+  muxer = ( sharedMuxer == NULL ) ? ownMuxer : sharedMuxer;
+  encoder = new QvkEncoder();
+
+  captureThread = new QvkCaptureThread( grabber, queue );
+  connect( captureThread, SIGNAL( error( QString ) ), this, SLOT( threadError( QString ) ), Qt::QueuedConnection );
+
+  encoderThread = new QvkEncoderThread( encoder, queue );
+  connect( encoderThread, SIGNAL( error( QString ) ), this, SLOT( threadError( QString ) ), Qt::QueuedConnection );
+
+  if ( encoderPool != NULL )
+    connect( encoderPool, SIGNAL( error( int, QString ) ), this, SLOT( poolError( int, QString ) ), Qt::QueuedConnection );
+
+  metricsTimer = new QTimer( this );
+  connect( metricsTimer, SIGNAL( timeout() ), this, SLOT( updateMetrics() ) );
+}
+
+
+QvkCaptureController::~QvkCaptureController()
+{
+  stop();
+  delete captureThread;
+  delete encoderThread;
+  delete encoder;
+  delete ownMuxer;
+  delete queue;
+  delete grabber;
+}
+
+
+bool QvkCaptureController::isRunning()
+{
+  return running;
+}
+
+
+bool QvkCaptureController::isPaused()
+{
+  return pausing;
+}
+
+
+QString QvkCaptureController::errorString()
+{
+  return lastError;
+}
+
+
+/**
+ * Opens display, encoder and file in the calling thread, so an error is known
+ * when start() returns. Then capture thread and encoder thread are started.
+ */
+bool QvkCaptureController::start( QvkCaptureSettings value )
+{
+  if ( prepare( value ) == false )
+    return false;
+
+  begin();
+  return true;
+}
+
+
+/**
+ * The first half of start(). With a shared muxer the stream is only added,
+ * the file and its header belong to the owner of the muxer.
+ */
+bool QvkCaptureController::prepare( QvkCaptureSettings value )
+{
+  if ( running == true )
+    return false;
+
+  settings = value;
+  lastError.clear();
+
+  // The encoders need an even size, the last column or row is cropped
+  settings.width -= settings.width % 2;
+  settings.height -= settings.height % 2;
+
+  // The capture thread only scales down, an output of the grabbed size is not resampled
+  if ( ( settings.outputWidth <= 0 ) or ( settings.outputHeight <= 0 ) or
+       ( settings.outputWidth > settings.width ) or ( settings.outputHeight > settings.height ) or
+       ( ( settings.outputWidth == settings.width ) and ( settings.outputHeight == settings.height ) ) )
+  {
+    settings.outputWidth = 0;
+    settings.outputHeight = 0;
+  }
+
+  if ( grabber->open( settings.display, settings.width, settings.height, settings.window ) == false )
+  {
+    lastError = grabber->errorString();
+    qDebug().noquote() << "[vokoscreen] [capture]" << lastError;
+    return false;
+  }
+
+  // Damage is also used with constant frame rate, only changed rectangles are grabbed
+  if ( grabber->enableDamage() == false )
+  {
+    qDebug().noquote() << "[vokoscreen] [capture]" << grabber->errorString() << "- grabbing the whole rectangle for every frame";
+    if ( settings.variableFrameRate == true )
+    {
+      qDebug().noquote() << "[vokoscreen] [capture] recording with constant frame rate";
+      settings.variableFrameRate = false;
+    }
+  }
+
+  if ( ( ownMuxer != NULL ) and ( muxer->open( settings.fileName, settings.format ) == false ) )
+    lastError = muxer->errorString();
+  else if ( encoder->open( muxer, settings.videoCodec,
+                           ( settings.outputWidth > 0 ) ? settings.outputWidth : settings.width,
+                           ( settings.outputHeight > 0 ) ? settings.outputHeight : settings.height,
+                           settings.frameRate, settings.codecOptions, settings.threads,
+                           settings.variableFrameRate ) == false )
+    lastError = encoder->errorString();
+  else if ( ( ownMuxer != NULL ) and ( muxer->writeHeader() == false ) )
+    lastError = muxer->errorString();
+
+  if ( lastError > "" )
+  {
+    qDebug().noquote() << "[vokoscreen] [capture]" << lastError;
+    encoder->close();
+    if ( ownMuxer != NULL )
+      muxer->close();
+    grabber->close();
+    return false;
+  }
+
+  return true;
+}
+
+
+void QvkCaptureController::begin()
+{
+  queue->reopen();
+  pausing = false;
+  captureThread->setPaused( false );
+  captureThread->setSettings( settings );
+  if ( encoderPool != NULL )
+    poolSession = encoderPool->add( encoder, queue );
+  else
+    encoderThread->start();
+  captureThread->start( QThread::HighPriority );
+
+  running = true;
+  lastFrameCount = 0;
+  lastPts = 0;
+  lastMetricsTime = 0;
+  lastBusyTime = encoderBusyTime();
+  metricsClock.start();
+  metricsTimer->start( 1000 );
+
+  qDebug().noquote() << "[vokoscreen] [capture] recording" << settings.fileName;
+  emit started();
+}
+
+
+/**
+ * Blocks until the encoder has written all frames and the file is closed.
+ */
+void QvkCaptureController::stop()
+{
+  if ( running == false )
+    return;
+
+  metricsTimer->stop();
+
+  captureThread->stop();
+  captureThread->wait();
+  if ( encoderPool != NULL )
+  {
+    encoderPool->waitForFinished( poolSession );
+    encoderPool->remove( poolSession );
+    poolSession = 0;
+  }
+  else
+  {
+    encoderThread->wait();
+  }
+
+  encoder->close();
+  if ( ownMuxer != NULL )
+    muxer->close();
+  grabber->close();
+
+  qDebug().noquote() << "[vokoscreen] [capture] stopped," << queue->dropped() << "frames dropped";
+
+  running = false;
+  pausing = false;
+  emit stopped();
+}
+
+
+/**
+ * The capture thread stops grabbing, encoder and file stay open.
+ */
+void QvkCaptureController::pause()
+{
+  if ( ( running == false ) or ( pausing == true ) )
+    return;
+
+  captureThread->setPaused( true );
+  pausing = true;
+  qDebug().noquote() << "[vokoscreen] [capture] paused";
+  emit paused();
+}
+
+
+void QvkCaptureController::resume()
+{
+  if ( ( running == false ) or ( pausing == false ) )
+    return;
+
+  captureThread->setPaused( false );
+  pausing = false;
+  qDebug().noquote() << "[vokoscreen] [capture] resumed";
+  emit resumed();
+}
+
+
+/**
+ * x, y: new upper left corner of the recorded rectangle on the screen.
+ * A window recorded with XComposite needs no origin.
+ */
+void QvkCaptureController::setCaptureOrigin( int x, int y )
+{
+  if ( ( running == false ) or ( settings.window != 0 ) )
+    return;
+
+  settings.x = x;
+  settings.y = y;
+  captureThread->setOrigin( x, y );
+}
+
+
+/**
+ * The stream has a millisecond time base, so the frame rate can change inside the file.
+ */
+void QvkCaptureController::setFrameRate( int value )
+{
+  if ( running == false )
+    return;
+
+  settings.frameRate = value;
+  captureThread->setFrameRate( value );
+  qDebug().noquote() << "[vokoscreen] [capture] frame rate" << value;
+}
+
+
+void QvkCaptureController::threadError( QString value )
+{
+  if ( running == false )
+    return;
+
+  lastError = value;
+  qDebug().noquote() << "[vokoscreen] [capture]" << value;
+  stop();
+  emit error( value );
+}
+
+
+/**
+ * The pool reports the errors of all sessions
+ */
+void QvkCaptureController::poolError( int id, QString value )
+{
+  if ( id == poolSession )
+    threadError( value );
+}
+
+
+qint64 QvkCaptureController::encoderBusyTime()
+{
+  if ( encoderPool != NULL )
+    return encoderPool->busyTime( poolSession );
+  return encoderThread->busyTime();
+}
+
+
+/**
+ * The same numbers as ffmpeg -progress gives for the process recorder.
+ * If frames are waiting in the queue, speed is the progress of the encoded
+ * timestamps against the wall clock, below 1.0 the encoder can not keep up.
+ * With an empty queue the encoder is waiting for frames, speed is then the
+ * wall clock time against the time spent in the encoder, e.g. 2.0 if the
+ * encoder was busy for the half of the time.
+ */
+void QvkCaptureController::updateMetrics()
+{
+  int frames = captureThread->framesCaptured();
+  qint64 pts = encoder->lastPts();
+  qint64 now = metricsClock.elapsed();
+  qint64 busy = encoderBusyTime();
+  qint64 interval = qMax( (qint64)1, now - lastMetricsTime );
+
+  QvkEncoderMetrics value;
+  value.frame = encoder->framesEncoded();
+  value.fps = ( frames - lastFrameCount ) * 1000.0 / interval;
+  value.totalSize = muxer->bytesWritten();
+  value.outTime = pts * 1000;
+  value.dropFrames = queue->dropped();
+  if ( pts > 0 )
+    value.bitrate = value.totalSize * 8.0 / pts;
+  if ( ( pausing == false ) and ( queue->count() == 0 ) )
+    value.speed = qMin( 10.0, interval * 1000.0 / qMax( (qint64)1, busy - lastBusyTime ) );
+  else if ( pausing == false )
+    value.speed = (double)( pts - lastPts ) / interval;
+
+  lastFrameCount = frames;
+  lastPts = pts;
+  lastMetricsTime = now;
+  lastBusyTime = busy;
+
+  emit metrics( value );
+}
@@ -0,0 +1,98 @@
+#ifndef QvkCaptureController_H
+#define QvkCaptureController_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+
+#include "QvkCaptureSettings.h"
+#include "QvkShmGrabber.h"
+#include "QvkFrameQueue.h"
+#include "QvkMuxer.h"
+#include "QvkEncoder.h"
+#include "QvkCaptureThread.h"
+#include "QvkEncoderThread.h"
+#include "QvkEncoderPool.h"
+#include "QvkEncoderMetrics.h"
+
+/*
+ * Native capture engine, records the screen without an external ffmpeg process.
+ *
+ * XShm capture thread --> QvkFrameQueue --> encoder thread --> QvkMuxer
+ *
+ * The controller lives in the GUI thread and has no dependency on widgets.
+ * Pause and resume keep the encoder and the file open.
+ *
+ * With a QvkEncoderPool the frames are encoded by the shared threads of the
+ * pool instead of an own encoder thread, e.g. for many displays at once.
+ *
+ * With a shared QvkMuxer the video is one track of a file with several
+ * tracks. The owner of the muxer opens it, calls prepare() of every
+ * controller, writes the header, calls begin() and closes the muxer after
+ * all controllers have stopped.
+ */
+class QvkCaptureController: public QObject
+{
+    Q_OBJECT
+
+public:
+  QvkCaptureController( QvkEncoderPool *pool = NULL, QvkMuxer *sharedMuxer = NULL );
+  virtual ~QvkCaptureController();
+
+  bool isRunning();
+  bool isPaused();
+  QString errorString();
+
+
+public slots:
+  bool start( QvkCaptureSettings value );
+  bool prepare( QvkCaptureSettings value );
+  void begin();
+  void stop();
+  void pause();
+  void resume();
+  void setCaptureOrigin( int x, int y );
+  void setFrameRate( int value );
+
+
+signals:
+  void started();
+  void stopped();
+  void paused();
+  void resumed();
+  void error( QString value );
+  void metrics( QvkEncoderMetrics value );
+
+
+private slots:
+  void threadError( QString value );
+  void poolError( int id, QString value );
+  void updateMetrics();
+
+
+private:
+  QvkCaptureSettings settings;
+  QvkShmGrabber *grabber;
+  QvkFrameQueue *queue;
+  QvkMuxer *muxer;
+  QvkMuxer *ownMuxer;
+  QvkEncoder *encoder;
+  QvkCaptureThread *captureThread;
+  QvkEncoderThread *encoderThread;
+  QvkEncoderPool *encoderPool;
+  int poolSession;
+  QTimer *metricsTimer;
+  QElapsedTimer metricsClock;
+  bool running;
+  bool pausing;
+  int lastFrameCount;
+  qint64 lastPts;
+  qint64 lastMetricsTime;
+  qint64 lastBusyTime;
+  QString lastError;
+
+  qint64 encoderBusyTime();
+
+};
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef QvkCaptureSettings_H
+#define QvkCaptureSettings_H
+
+#include <QString>
+#include <QStringList>
+#include <QMetaType>
+
+/*
+ * Everything the native capture engine needs for one recording.
+ * codecOptions uses the same pairs as the ffmpeg command line,
+ * e.g. "-preset" "veryfast" or "-qp" "0".
+ */
+struct QvkCaptureSettings
+{
+  QString display;
+  int x = 0;
+  int y = 0;
+  int width = 0;
+  int height = 0;
+  int outputWidth = 0;            // Scaled down in the capture thread, 0 keeps the grabbed size
+  int outputHeight = 0;
+  int frameRate = 25;
+  bool showCursor = true;
+  bool variableFrameRate = false; // Only changed frames are grabbed, frameRate is the maximum
+  unsigned long window = 0;       // Records this window with XComposite, x and y are not used
+  bool followCursor = false;      // The rectangle follows the mouse, x and y are the start
+
+  QString fileName;
+  QString format;
+  QString videoCodec;
+  QStringList codecOptions;
+  int threads = 0;
+};
+
+Q_DECLARE_METATYPE( QvkCaptureSettings )
+
+#endif
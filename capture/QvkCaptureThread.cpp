@@ -0,0 +1,210 @@
+#include "QvkCaptureThread.h"
+#include "QvkCursorPan.h"
+
+#include <QElapsedTimer>
+#include <QDebug>
+
+QvkCaptureThread::QvkCaptureThread( QvkShmGrabber *grabber, QvkFrameQueue *queue )
+{
+  shmGrabber = grabber;
+  frameQueue = queue;
+  stopRequested = 0;
+  pauseRequested = 0;
+  originX = 0;
+  originY = 0;
+  frameRate = 25;
+  capturedFrames = 0;
+}
+
+
+QvkCaptureThread::~QvkCaptureThread()
+{
+}
+
+
+void QvkCaptureThread::setSettings( QvkCaptureSettings value )
+{
+  settings = value;
+  originX = value.x;
+  originY = value.y;
+  frameRate = qMax( 1, value.frameRate );
+}
+
+
+void QvkCaptureThread::stop()
+{
+  stopRequested = 1;
+}
+
+
+void QvkCaptureThread::setPaused( bool value )
+{
+  pauseRequested = value ? 1 : 0;
+}
+
+
+/**
+ * Can be called while the thread is running, e.g. when the recorded window is moved.
+ */
+void QvkCaptureThread::setOrigin( int x, int y )
+{
+  originX = x;
+  originY = y;
+}
+
+
+/**
+ * Can be called while the thread is running, the new rate is used from the next frame on.
+ */
+void QvkCaptureThread::setFrameRate( int value )
+{
+  frameRate = qMax( 1, value );
+}
+
+
+int QvkCaptureThread::framesCaptured()
+{
+  return capturedFrames;
+}
+
+
+void QvkCaptureThread::run()
+{
+  stopRequested = 0;
+  capturedFrames = 0;
+
+  int rate = frameRate;
+  qint64 interval = 1000000 / rate; // microseconds
+  qint64 tick = 0;
+  bool idle = false;
+  bool force = false;
+  qint64 pauseBegin = -1;
+  qint64 pauseOffset = 0; // microseconds
+
+  // The pan replaces the origin of setOrigin(), a window has no rectangle to move
+  bool follow = ( settings.followCursor == true ) and ( settings.window == 0 );
+  qint64 panTime = 0;
+  QvkCursorPan pan;
+  pan.reset( QRect( 0, 0, shmGrabber->screenWidth(), shmGrabber->screenHeight() ),
+             QSize( shmGrabber->width(), shmGrabber->height() ),
+             QPoint( originX, originY ) );
+
+  downscale.setSize( shmGrabber->width(), shmGrabber->height(),
+                     ( settings.outputWidth > 0 ) ? settings.outputWidth : shmGrabber->width(),
+                     ( settings.outputHeight > 0 ) ? settings.outputHeight : shmGrabber->height() );
+
+  QElapsedTimer clock;
+  clock.start();
+
+  while ( stopRequested == 0 )
+  {
+    if ( pauseRequested == 1 )
+    {
+      if ( pauseBegin < 0 )
+      {
+        pauseBegin = clock.nsecsElapsed() / 1000;
+
+        // The last picture before the pause must get its duration
+        if ( ( settings.variableFrameRate == true ) and ( idle == true ) )
+          pushFrame( ( pauseBegin - pauseOffset ) / 1000 );
+        idle = false;
+      }
+      msleep( 10 );
+      continue;
+    }
+
+    if ( pauseBegin >= 0 )
+    {
+      qint64 now = clock.nsecsElapsed() / 1000;
+      pauseOffset += now - pauseBegin;
+      pauseBegin = -1;
+      tick = now / interval;
+      force = true;
+    }
+
+    if ( frameRate != rate )
+    {
+      rate = frameRate;
+      interval = 1000000 / rate;
+      tick = clock.nsecsElapsed() / 1000 / interval + 1;
+    }
+
+    qint64 due = tick * interval;
+    qint64 now = clock.nsecsElapsed() / 1000;
+    if ( now < due )
+    {
+      usleep( due - now );
+      continue;
+    }
+
+    // If we are more than one frame late, the missed frames are skipped
+    tick = now / interval + 1;
+
+    int x = originX;
+    int y = originY;
+    if ( follow == true )
+    {
+      int cursorX, cursorY;
+      shmGrabber->cursorPosition( &cursorX, &cursorY );
+      QPoint origin = pan.next( QPoint( cursorX, cursorY ), now - panTime );
+      panTime = now;
+      x = origin.x();
+      y = origin.y();
+    }
+    if ( shmGrabber->update( x, y ) == false )
+    {
+      emit error( shmGrabber->errorString() );
+      break;
+    }
+
+    // isCursorChanged() must always be called, it resets its state
+    bool changed = shmGrabber->isChanged() or force;
+    if ( settings.showCursor == true )
+      changed = shmGrabber->isCursorChanged( x, y ) or changed;
+    force = false;
+
+    if ( ( settings.variableFrameRate == true ) and ( changed == false ) )
+    {
+      idle = true;
+      continue;
+    }
+
+    idle = false;
+    pushFrame( ( now - pauseOffset ) / 1000 );
+  }
+
+  // Repeat the last picture at the end, otherwise a static end of the recording has no duration
+  if ( ( settings.variableFrameRate == true ) and ( idle == true ) and ( capturedFrames > 0 ) )
+    pushFrame( ( clock.nsecsElapsed() / 1000 - pauseOffset ) / 1000 );
+
+  frameQueue->close();
+}
+
+
+/**
+ * The frame shares the data with the frame buffer of the grabber, nothing is copied here.
+ * A scaled frame has its own buffer, the frame buffer of the grabber is then never shared.
+ */
+void QvkCaptureThread::pushFrame( qint64 pts )
+{
+  if ( settings.showCursor == true )
+    shmGrabber->drawCursor();
+
+  QvkFrame frame;
+  frame.width = shmGrabber->width();
+  frame.height = shmGrabber->height();
+  frame.stride = shmGrabber->bytesPerLine();
+  frame.pts = pts;
+  frame.data = shmGrabber->frameBuffer();
+
+  if ( downscale.isActive() )
+  {
+    frame.data = downscale.scale( frame.data, frame.stride );
+    frame.width = settings.outputWidth;
+    frame.height = settings.outputHeight;
+    frame.stride = frame.width * 4;
+  }
+
+  frameQueue->push( frame );
+  capturedFrames.ref();
+}
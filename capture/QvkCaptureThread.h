@@ -0,0 +1,66 @@
+#ifndef QvkCaptureThread_H
+#define QvkCaptureThread_H
+
+#include <QThread>
+#include <QAtomicInt>
+
+#include "QvkShmGrabber.h"
+#include "QvkFrameQueue.h"
+#include "QvkCaptureSettings.h"
+#include "QvkDownscale.h"
+
+/*
+ * Grabs the screen with the given frame rate and puts the frames into the queue.
+ * The grabber must be opened before the thread is started.
+ *
+ * While paused no frames are grabbed, the time of the pause is removed
+ * from the timestamps, so the encoder sees one continuous recording.
+ *
+ * With followCursor the rectangle is moved after the mouse by QvkCursorPan
+ * before every frame, only the rectangle is grabbed.
+ *
+ * With an output size the frames are scaled down by QvkDownscale before
+ * they go into the queue.
+ */
+class QvkCaptureThread: public QThread
+{
+    Q_OBJECT
+
+public:
+  QvkCaptureThread( QvkShmGrabber *grabber, QvkFrameQueue *queue );
+  virtual ~QvkCaptureThread();
+
+  void setSettings( QvkCaptureSettings value );
+  void stop();
+  void setPaused( bool value );
+  void setOrigin( int x, int y );
+  void setFrameRate( int value );
+
+  int framesCaptured();
+
+
+signals:
+  void error( QString value );
+
+
+protected:
+  void run();
+
+
+private:
+  void pushFrame( qint64 pts );
+
+  QvkShmGrabber *shmGrabber;
+  QvkDownscale downscale;
+  QvkFrameQueue *frameQueue;
+  QvkCaptureSettings settings;
+  QAtomicInt stopRequested;
+  QAtomicInt pauseRequested;
+  QAtomicInt originX;
+  QAtomicInt originY;
+  QAtomicInt frameRate;
+  QAtomicInt capturedFrames;
+
+};
+
+#endif
@@ -0,0 +1,72 @@
+#include "QvkCursorPan.h"
+
+#include <math.h>
+
+QvkCursorPan::QvkCursorPan()
+{
+  x = 0;
+  y = 0;
+}
+
+
+QvkCursorPan::~QvkCursorPan()
+{
+}
+
+
+/**
+ * screen: the rectangle can not leave it
+ * size: size of the recorded rectangle
+ * origin: upper left corner at the begin
+ */
+void QvkCursorPan::reset( QRect screen, QSize size, QPoint origin )
+{
+  screenRect = screen;
+  cropSize = size;
+  x = origin.x();
+  y = origin.y();
+}
+
+
+/**
+ * Where the upper left corner has to go on one axis
+ */
+double QvkCursorPan::target( double position, int cursor, int length, int minimum, int maximum )
+{
+  double margin = length / 4.0;
+  double value = position;
+
+  if ( cursor < position + margin )
+    value = cursor - margin;
+  else if ( cursor > position + length - margin )
+    value = cursor - length + margin;
+
+  return qBound( (double)minimum, value, (double)qMax( minimum, maximum ) );
+}
+
+
+/**
+ * cursor: position of the mouse on the screen
+ * elapsed: microseconds since the last call
+ * Returns the new upper left corner.
+ */
+QPoint QvkCursorPan::next( QPoint cursor, qint64 elapsed )
+{
+  double targetX = target( x, cursor.x(), cropSize.width(),
+                           screenRect.left(), screenRect.right() + 1 - cropSize.width() );
+  double targetY = target( y, cursor.y(), cropSize.height(),
+                           screenRect.top(), screenRect.bottom() + 1 - cropSize.height() );
+
+  // Time constant 150 ms, after 150 ms two thirds of the way are done
+  double factor = 1.0 - exp( -elapsed / 150000.0 );
+  x += ( targetX - x ) * factor;
+  y += ( targetY - y ) * factor;
+
+  // The last half pixel would never be reached, every frame would be a changed frame
+  if ( fabs( targetX - x ) < 0.5 )
+    x = targetX;
+  if ( fabs( targetY - y ) < 0.5 )
+    y = targetY;
+
+  return QPoint( qRound( x ), qRound( y ) );
+}
@@ -0,0 +1,36 @@
+#ifndef QvkCursorPan_H
+#define QvkCursorPan_H
+
+#include <QRect>
+#include <QPoint>
+#include <QSize>
+
+/*
+ * Moves a recorded rectangle after the mouse cursor.
+ *
+ * While the cursor is in the dead zone, the middle half of the rectangle,
+ * nothing moves. If it leaves the dead zone, the rectangle glides towards
+ * the position that brings the cursor back to the edge of the dead zone.
+ * The easing uses the time between two frames, so it looks the same with
+ * every frame rate.
+ */
+class QvkCursorPan
+{
+public:
+  QvkCursorPan();
+  virtual ~QvkCursorPan();
+
+  void reset( QRect screen, QSize size, QPoint origin );
+  QPoint next( QPoint cursor, qint64 elapsed );
+
+private:
+  QRect screenRect;
+  QSize cropSize;
+  double x;
+  double y;
+
+  double target( double position, int cursor, int length, int minimum, int maximum );
+
+};
+
+#endif
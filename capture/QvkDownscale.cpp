@@ -0,0 +1,329 @@
+#include "QvkDownscale.h"
+
+#include <QDebug>
+
+#include <math.h>
+#include <string.h>
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+#include <immintrin.h>
+#define VK_X86
+#endif
+
+/*
+ * Kernels
+ *
+ * box:        two source rows into one row of half width, (a + b + c + d + 2) / 4
+ * vertical:   two source rows into one row of 16 bit values, a * ( 128 - w ) + b * w
+ * horizontal: the 16 bit row into the target row, weights also in 1/128
+ */
+
+static void boxC( const uchar *row0, const uchar *row1, uchar *dst, int width )
+{
+  for ( int x = 0; x < width; x++ )
+  {
+    for ( int c = 0; c < 4; c++ )
+      dst[ c ] = ( row0[ c ] + row0[ c + 4 ] + row1[ c ] + row1[ c + 4 ] + 2 ) >> 2;
+    row0 += 8;
+    row1 += 8;
+    dst += 4;
+  }
+}
+
+
+static void verticalC( const uchar *row0, const uchar *row1, quint16 *dst, int bytes, int weight )
+{
+  for ( int i = 0; i < bytes; i++ )
+    dst[ i ] = row0[ i ] * ( 128 - weight ) + row1[ i ] * weight;
+}
+
+
+static void horizontalC( const quint16 *row, const int *index, const int *next, const qint16 *weight, uchar *dst, int width )
+{
+  for ( int x = 0; x < width; x++ )
+  {
+    const quint16 *a = row + index[ x ] * 4;
+    const quint16 *b = row + next[ x ] * 4;
+    for ( int c = 0; c < 4; c++ )
+      dst[ c ] = ( a[ c ] * ( 128 - weight[ x ] ) + b[ c ] * weight[ x ] + 8192 ) >> 14;
+    dst += 4;
+  }
+}
+
+
+#ifdef VK_X86
+
+/**
+ * 4 source pixels into 2 target pixels per step
+ */
+__attribute__(( target( "sse2" ) ))
+static void boxSse2( const uchar *row0, const uchar *row1, uchar *dst, int width )
+{
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i two = _mm_set1_epi16( 2 );
+  int x = 0;
+  for ( ; x + 2 <= width; x += 2 )
+  {
+    __m128i a = _mm_loadu_si128( (const __m128i *)( row0 + x * 8 ) );
+    __m128i b = _mm_loadu_si128( (const __m128i *)( row1 + x * 8 ) );
+    __m128i low  = _mm_add_epi16( _mm_unpacklo_epi8( a, zero ), _mm_unpacklo_epi8( b, zero ) ); // p0 p1
+    __m128i high = _mm_add_epi16( _mm_unpackhi_epi8( a, zero ), _mm_unpackhi_epi8( b, zero ) ); // p2 p3
+    low  = _mm_add_epi16( low,  _mm_srli_si128( low,  8 ) );
+    high = _mm_add_epi16( high, _mm_srli_si128( high, 8 ) );
+    __m128i sum = _mm_srli_epi16( _mm_add_epi16( _mm_unpacklo_epi64( low, high ), two ), 2 );
+    _mm_storel_epi64( (__m128i *)( dst + x * 4 ), _mm_packus_epi16( sum, sum ) );
+  }
+  boxC( row0 + x * 8, row1 + x * 8, dst + x * 4, width - x );
+}
+
+
+__attribute__(( target( "sse2" ) ))
+static void verticalSse2( const uchar *row0, const uchar *row1, quint16 *dst, int bytes, int weight )
+{
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i weight0 = _mm_set1_epi16( 128 - weight );
+  const __m128i weight1 = _mm_set1_epi16( weight );
+  int i = 0;
+  for ( ; i + 16 <= bytes; i += 16 )
+  {
+    __m128i a = _mm_loadu_si128( (const __m128i *)( row0 + i ) );
+    __m128i b = _mm_loadu_si128( (const __m128i *)( row1 + i ) );
+    __m128i low  = _mm_add_epi16( _mm_mullo_epi16( _mm_unpacklo_epi8( a, zero ), weight0 ),
+                                  _mm_mullo_epi16( _mm_unpacklo_epi8( b, zero ), weight1 ) );
+    __m128i high = _mm_add_epi16( _mm_mullo_epi16( _mm_unpackhi_epi8( a, zero ), weight0 ),
+                                  _mm_mullo_epi16( _mm_unpackhi_epi8( b, zero ), weight1 ) );
+    _mm_storeu_si128( (__m128i *)( dst + i ), low );
+    _mm_storeu_si128( (__m128i *)( dst + i + 8 ), high );
+  }
+  verticalC( row0 + i, row1 + i, dst + i, bytes - i, weight );
+}
+
+
+/**
+ * One target pixel per step, the four channels of both source pixels
+ * are interleaved and multiplied with the weight pair by pmaddwd.
+ */
+__attribute__(( target( "sse2" ) ))
+static void horizontalSse2( const quint16 *row, const int *index, const int *next, const qint16 *weight, uchar *dst, int width )
+{
+  const __m128i round = _mm_set1_epi32( 8192 );
+  for ( int x = 0; x < width; x++ )
+  {
+    __m128i a = _mm_loadl_epi64( (const __m128i *)( row + index[ x ] * 4 ) );
+    __m128i b = _mm_loadl_epi64( (const __m128i *)( row + next[ x ] * 4 ) );
+    __m128i pair = _mm_set1_epi32( ( weight[ x ] << 16 ) | ( 128 - weight[ x ] ) );
+    __m128i sum = _mm_madd_epi16( _mm_unpacklo_epi16( a, b ), pair );
+    sum = _mm_srai_epi32( _mm_add_epi32( sum, round ), 14 );
+    sum = _mm_packs_epi32( sum, sum );
+    int pixel = _mm_cvtsi128_si32( _mm_packus_epi16( sum, sum ) );
+    memcpy( dst + x * 4, &pixel, 4 );
+  }
+}
+
+
+/**
+ * 8 source pixels into 4 target pixels per step. unpack and the byte shift
+ * work in both 128 bit lanes, the two results are joined at the end.
+ */
+__attribute__(( target( "avx2" ) ))
+static void boxAvx2( const uchar *row0, const uchar *row1, uchar *dst, int width )
+{
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i two = _mm256_set1_epi16( 2 );
+  int x = 0;
+  for ( ; x + 4 <= width; x += 4 )
+  {
+    __m256i a = _mm256_loadu_si256( (const __m256i *)( row0 + x * 8 ) );
+    __m256i b = _mm256_loadu_si256( (const __m256i *)( row1 + x * 8 ) );
+    __m256i low  = _mm256_add_epi16( _mm256_unpacklo_epi8( a, zero ), _mm256_unpacklo_epi8( b, zero ) );
+    __m256i high = _mm256_add_epi16( _mm256_unpackhi_epi8( a, zero ), _mm256_unpackhi_epi8( b, zero ) );
+    low  = _mm256_add_epi16( low,  _mm256_srli_si256( low,  8 ) );
+    high = _mm256_add_epi16( high, _mm256_srli_si256( high, 8 ) );
+    __m256i sum = _mm256_srli_epi16( _mm256_add_epi16( _mm256_unpacklo_epi64( low, high ), two ), 2 );
+    sum = _mm256_permute4x64_epi64( _mm256_packus_epi16( sum, sum ), 0x08 );
+    _mm_storeu_si128( (__m128i *)( dst + x * 4 ), _mm256_castsi256_si128( sum ) );
+  }
+  boxSse2( row0 + x * 8, row1 + x * 8, dst + x * 4, width - x );
+}
+
+
+__attribute__(( target( "avx2" ) ))
+static void verticalAvx2( const uchar *row0, const uchar *row1, quint16 *dst, int bytes, int weight )
+{
+  const __m256i weight0 = _mm256_set1_epi16( 128 - weight );
+  const __m256i weight1 = _mm256_set1_epi16( weight );
+  int i = 0;
+  for ( ; i + 16 <= bytes; i += 16 )
+  {
+    __m256i a = _mm256_cvtepu8_epi16( _mm_loadu_si128( (const __m128i *)( row0 + i ) ) );
+    __m256i b = _mm256_cvtepu8_epi16( _mm_loadu_si128( (const __m128i *)( row1 + i ) ) );
+    __m256i sum = _mm256_add_epi16( _mm256_mullo_epi16( a, weight0 ), _mm256_mullo_epi16( b, weight1 ) );
+    _mm256_storeu_si256( (__m256i *)( dst + i ), sum );
+  }
+  verticalC( row0 + i, row1 + i, dst + i, bytes - i, weight );
+}
+
+#endif
+
+
+typedef void ( *BoxKernel )( const uchar *, const uchar *, uchar *, int );
+typedef void ( *VerticalKernel )( const uchar *, const uchar *, quint16 *, int, int );
+typedef void ( *HorizontalKernel )( const quint16 *, const int *, const int *, const qint16 *, uchar *, int );
+
+struct Kernels
+{
+  BoxKernel box;
+  VerticalKernel vertical;
+  HorizontalKernel horizontal;
+  const char *name;
+};
+
+static Kernels chooseKernels()
+{
+  Kernels value = { boxC, verticalC, horizontalC, "c" };
+#ifdef VK_X86
+  __builtin_cpu_init();
+  if ( __builtin_cpu_supports( "sse2" ) )
+  {
+    value.box = boxSse2;
+    value.vertical = verticalSse2;
+    value.horizontal = horizontalSse2;
+    value.name = "sse2";
+  }
+  if ( __builtin_cpu_supports( "avx2" ) )
+  {
+    value.box = boxAvx2;
+    value.vertical = verticalAvx2;
+    value.name = "avx2";
+  }
+#endif
+  return value;
+}
+
+static const Kernels kernels = chooseKernels();
+
+
+QvkDownscale::QvkDownscale()
+{
+  sourceW = 0;
+  sourceH = 0;
+  targetW = 0;
+  targetH = 0;
+  boxSteps = 0;
+  bilinearW = 0;
+  bilinearH = 0;
+}
+
+
+QvkDownscale::~QvkDownscale()
+{
+}
+
+
+QString QvkDownscale::kernelName()
+{
+  return kernels.name;
+}
+
+
+/**
+ * Source position of every target position, the centers of the pixels are kept in place.
+ */
+void QvkDownscale::tables( int from, int to, QVector<int> *index, QVector<int> *next, QVector<qint16> *weight )
+{
+  index->resize( to );
+  next->resize( to );
+  weight->resize( to );
+  for ( int i = 0; i < to; i++ )
+  {
+    double position = qMax( 0.0, ( i + 0.5 ) * from / to - 0.5 );
+    int first = qMin( (int)floor( position ), from - 1 );
+    ( *index )[ i ] = first;
+    ( *next )[ i ] = qMin( first + 1, from - 1 );
+    ( *weight )[ i ] = qRound( ( position - first ) * 128 );
+  }
+}
+
+
+/**
+ * The target size must not be larger than the source size.
+ */
+void QvkDownscale::setSize( int sourceWidth, int sourceHeight, int targetWidth, int targetHeight )
+{
+  sourceW = sourceWidth;
+  sourceH = sourceHeight;
+  targetW = qBound( 1, targetWidth, sourceWidth );
+  targetH = qBound( 1, targetHeight, sourceHeight );
+
+  boxSteps = 0;
+  bilinearW = sourceW;
+  bilinearH = sourceH;
+  while ( ( bilinearW >= targetW * 2 ) and ( bilinearH >= targetH * 2 ) )
+  {
+    bilinearW /= 2;
+    bilinearH /= 2;
+    boxSteps++;
+  }
+
+  tables( bilinearW, targetW, &xIndex, &xNext, &xWeight );
+  tables( bilinearH, targetH, &yIndex, &yNext, &yWeight );
+  rowBuffer.resize( bilinearW * 4 );
+
+  if ( isActive() )
+    qDebug().noquote() << "[vokoscreen] [capture] scale" << sourceW << "x" << sourceH << "to" << targetW << "x" << targetH
+                       << "with" << boxSteps << "box steps and" << kernelName();
+}
+
+
+bool QvkDownscale::isActive()
+{
+  return ( sourceW != targetW ) or ( sourceH != targetH );
+}
+
+
+/**
+ * Returns a new picture with the target size and a stride of width * 4.
+ * The buffer is reused if the encoder has released the last one.
+ */
+QByteArray QvkDownscale::scale( const QByteArray &source, int sourceStride )
+{
+  int size = targetW * 4 * targetH;
+  if ( ( output.size() != size ) or ( output.isDetached() == false ) )
+    output = QByteArray( size, Qt::Uninitialized );
+
+  const uchar *src = (const uchar *)source.constData();
+  int stride = sourceStride;
+  int width = sourceW;
+  int height = sourceH;
+
+  for ( int step = 0; step < boxSteps; step++ )
+  {
+    int halfWidth = width / 2;
+    int halfHeight = height / 2;
+    bool last = ( step == boxSteps - 1 ) and ( halfWidth == targetW ) and ( halfHeight == targetH );
+    QByteArray &half = halfBuffer[ step % 2 ];
+    if ( last == false )
+      half.resize( halfWidth * 4 * halfHeight );
+    uchar *dst = last ? (uchar *)output.data() : (uchar *)half.data();
+
+    for ( int y = 0; y < halfHeight; y++ )
+      kernels.box( src + 2 * y * stride, src + ( 2 * y + 1 ) * stride, dst + y * halfWidth * 4, halfWidth );
+
+    if ( last == true )
+      return output;
+
+    src = dst;
+    stride = halfWidth * 4;
+    width = halfWidth;
+    height = halfHeight;
+  }
+
+  uchar *dst = (uchar *)output.data();
+  for ( int y = 0; y < targetH; y++ )
+  {
+    kernels.vertical( src + yIndex[ y ] * stride, src + yNext[ y ] * stride, rowBuffer.data(), width * 4, yWeight[ y ] );
+    kernels.horizontal( rowBuffer.constData(), xIndex.constData(), xNext.constData(), xWeight.constData(), dst + y * targetW * 4, targetW );
+  }
+
+  return output;
+}
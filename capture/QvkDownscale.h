@@ -0,0 +1,54 @@
+#ifndef QvkDownscale_H
+#define QvkDownscale_H
+
+#include <QByteArray>
+#include <QVector>
+#include <QString>
+
+/*
+ * Scales BGRA frames down in the capture thread, before the color conversion
+ * of the encoder, e.g. a 4K HiDPI screen to a 1080p video. swscale then only
+ * converts the small picture and the encoder gets fewer pixels.
+ *
+ * As long as the picture is at least twice the target size it is halved with
+ * a 2:1 box filter, the rest is done with a bilinear filter. Halving first
+ * gives the quality of an area filter, the bilinear filter alone would skip
+ * source pixels with a factor above two.
+ *
+ * The kernels are chosen once at runtime: AVX2, SSE2 or plain C.
+ */
+class QvkDownscale
+{
+public:
+  QvkDownscale();
+  virtual ~QvkDownscale();
+
+  void setSize( int sourceWidth, int sourceHeight, int targetWidth, int targetHeight );
+  bool isActive();
+  QByteArray scale( const QByteArray &source, int sourceStride );
+
+  static QString kernelName();
+
+private:
+  int sourceW;
+  int sourceH;
+  int targetW;
+  int targetH;
+  int boxSteps;
+  int bilinearW; // Size before the bilinear step
+  int bilinearH;
+  QByteArray halfBuffer[ 2 ];
+  QByteArray output;
+  QVector<quint16> rowBuffer;
+  QVector<int> xIndex;
+  QVector<int> xNext;
+  QVector<qint16> xWeight;
+  QVector<int> yIndex;
+  QVector<int> yNext;
+  QVector<qint16> yWeight;
+
+  void tables( int from, int to, QVector<int> *index, QVector<int> *next, QVector<qint16> *weight );
+
+};
+
+#endif
@@ -0,0 +1,270 @@
+#include "QvkEncoder.h"
+
+#include <QDebug>
+
+extern "C"
+{
+#include <libavutil/imgutils.h>
+#include <libavutil/opt.h>
+}
+
+QvkEncoder::QvkEncoder()
+{
+  codecContext = NULL;
+  stream = NULL;
+  picture = NULL;
+  swsContext = NULL;
+  muxer = NULL;
+  encodedFrames.store( 0 );
+  lastTimestamp.store( -1 );
+}
+
+
+QvkEncoder::~QvkEncoder()
+{
+  close();
+}
+
+
+QString QvkEncoder::avError( int value )
+{
+  char buffer[ AV_ERROR_MAX_STRING_SIZE ] = { 0 };
+  av_strerror( value, buffer, sizeof( buffer ) );
+  return QString::fromLocal8Bit( buffer );
+}
+
+
+/**
+ * libx264rgb can take the pixels from the X server without conversion,
+ * all others get yuv420p like the x11grab command line, if the codec supports it.
+ */
+AVPixelFormat QvkEncoder::choosePixelFormat( const AVCodec *codec, QString codecName )
+{
+  if ( codec->pix_fmts == NULL )
+    return AV_PIX_FMT_YUV420P;
+
+  AVPixelFormat wanted = AV_PIX_FMT_YUV420P;
+  if ( codecName == "libx264rgb" )
+    wanted = AV_PIX_FMT_BGR0;
+
+  for ( const AVPixelFormat *format = codec->pix_fmts; *format != AV_PIX_FMT_NONE; format++ )
+  {
+    if ( *format == wanted )
+      return wanted;
+  }
+
+  return avcodec_find_best_pix_fmt_of_list( codec->pix_fmts, AV_PIX_FMT_BGRA, 0, NULL );
+}
+
+
+/**
+ * codecOptions: pairs as on the ffmpeg command line, "-preset" "veryfast" "-qp" "0" ...
+ */
+bool QvkEncoder::open( QvkMuxer *value,
+                       QString codecName,
+                       int width,
+                       int height,
+                       int frameRate,
+                       QStringList codecOptions,
+                       int threads,
+                       bool variableFrameRate )
+{
+  close();
+  muxer = value;
+
+  const AVCodec *codec = avcodec_find_encoder_by_name( codecName.toLatin1().constData() );
+  if ( codec == NULL )
+  {
+    error = "Encoder " + codecName + " not found";
+    return false;
+  }
+
+  codecContext = avcodec_alloc_context3( codec );
+  codecContext->width = width;
+  codecContext->height = height;
+  codecContext->pix_fmt = choosePixelFormat( codec, codecName );
+  codecContext->time_base = AVRational{ 1, 1000 };
+  codecContext->framerate = AVRational{ frameRate, 1 };
+  codecContext->thread_count = threads;
+  if ( muxer->needsGlobalHeader() )
+    codecContext->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+
+  AVDictionary *options = NULL;
+  for ( int i = 0; i + 1 < codecOptions.count(); i += 2 )
+  {
+    // "-b:v" is "b" for the codec context, the stream specifier is only for the command line
+    QString key = codecOptions[ i ];
+    key.remove( 0, 1 );
+    key = key.section( ":", 0, 0 );
+    av_dict_set( &options, key.toLatin1().constData(), codecOptions[ i + 1 ].toLatin1().constData(), 0 );
+  }
+
+  int ret = avcodec_open2( codecContext, codec, &options );
+  AVDictionaryEntry *entry = NULL;
+  while ( ( entry = av_dict_get( options, "", entry, AV_DICT_IGNORE_SUFFIX ) ) )
+  {
+    qDebug().noquote() << "[vokoscreen] [capture] codec option not used:" << entry->key << entry->value;
+  }
+  av_dict_free( &options );
+
+  if ( ret < 0 )
+  {
+    error = "Can not open encoder " + codecName + ": " + avError( ret );
+    close();
+    return false;
+  }
+
+  stream = muxer->addStream( codecContext );
+  if ( stream == NULL )
+  {
+    error = muxer->errorString();
+    close();
+    return false;
+  }
+
+  // The frame rate is only a hint for the rate control, the container gets no fixed rate
+  if ( variableFrameRate == true )
+    stream->avg_frame_rate = AVRational{ 0, 1 };
+
+  picture = av_frame_alloc();
+  picture->format = codecContext->pix_fmt;
+  picture->width = width;
+  picture->height = height;
+  ret = av_frame_get_buffer( picture, 32 );
+  if ( ret < 0 )
+  {
+    error = "Can not allocate frame: " + avError( ret );
+    close();
+    return false;
+  }
+
+  qDebug().noquote() << "[vokoscreen] [capture] encoder" << codecName
+                     << av_get_pix_fmt_name( codecContext->pix_fmt )
+                     << width << "x" << height << "threads" << threads;
+  return true;
+}
+
+
+bool QvkEncoder::encode( const QvkFrame &frame )
+{
+  // A timestamp may not be used twice, this happens if two frames come in the same millisecond
+  if ( frame.pts <= lastTimestamp.load() )
+    return true;
+
+  int ret = av_frame_make_writable( picture );
+  if ( ret < 0 )
+  {
+    error = "Frame not writable: " + avError( ret );
+    return false;
+  }
+
+  swsContext = sws_getCachedContext( swsContext,
+                                     frame.width, frame.height, AV_PIX_FMT_BGRA,
+                                     codecContext->width, codecContext->height, codecContext->pix_fmt,
+                                     SWS_BILINEAR, NULL, NULL, NULL );
+  if ( swsContext == NULL )
+  {
+    error = "Can not create the color converter";
+    return false;
+  }
+
+  const uint8_t *srcSlice[ 4 ] = { (const uint8_t *)frame.data.constData(), NULL, NULL, NULL };
+  int srcStride[ 4 ] = { frame.stride, 0, 0, 0 };
+  sws_scale( swsContext, srcSlice, srcStride, 0, frame.height, picture->data, picture->linesize );
+
+  picture->pts = frame.pts;
+  lastTimestamp.store( frame.pts );
+
+  ret = avcodec_send_frame( codecContext, picture );
+  if ( ret < 0 )
+  {
+    error = "Can not encode frame: " + avError( ret );
+    return false;
+  }
+
+  encodedFrames.fetchAndAddRelaxed( 1 );
+  return receivePackets();
+}
+
+
+bool QvkEncoder::receivePackets()
+{
+  AVPacket *packet = av_packet_alloc();
+  bool ok = true;
+  while ( true )
+  {
+    int ret = avcodec_receive_packet( codecContext, packet );
+    if ( ( ret == AVERROR( EAGAIN ) ) or ( ret == AVERROR_EOF ) )
+      break;
+
+    if ( ret < 0 )
+    {
+      error = "Can not receive packet: " + avError( ret );
+      ok = false;
+      break;
+    }
+
+    av_packet_rescale_ts( packet, codecContext->time_base, stream->time_base );
+    packet->stream_index = stream->index;
+    if ( muxer->writePacket( packet ) == false )
+    {
+      error = muxer->errorString();
+      ok = false;
+      break;
+    }
+  }
+  av_packet_free( &packet );
+  return ok;
+}
+
+
+/**
+ * Gives the encoder the signal that no more frames come
+ * and writes all delayed packets.
+ */
+bool QvkEncoder::flush()
+{
+  if ( codecContext == NULL )
+    return true;
+
+  avcodec_send_frame( codecContext, NULL );
+  return receivePackets();
+}
+
+
+void QvkEncoder::close()
+{
+  if ( swsContext != NULL )
+  {
+    sws_freeContext( swsContext );
+    swsContext = NULL;
+  }
+
+  if ( picture != NULL )
+    av_frame_free( &picture );
+
+  if ( codecContext != NULL )
+    avcodec_free_context( &codecContext );
+
+  stream = NULL;
+  encodedFrames.store( 0 );
+  lastTimestamp.store( -1 );
+}
+
+
+qint64 QvkEncoder::framesEncoded()
+{
+  return encodedFrames.load();
+}
+
+
+qint64 QvkEncoder::lastPts()
+{
+  return lastTimestamp.load();
+}
+
+
+QString QvkEncoder::errorString()
+{
+  return error;
+}
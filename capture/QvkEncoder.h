@@ -0,0 +1,63 @@
+#ifndef QvkEncoder_H
+#define QvkEncoder_H
+
+#include <QString>
+#include <QStringList>
+#include <QAtomicInteger>
+
+#include "QvkFrame.h"
+#include "QvkMuxer.h"
+
+extern "C"
+{
+#include <libavcodec/avcodec.h>
+#include <libswscale/swscale.h>
+}
+
+/*
+ * Converts BGRA frames with swscale and encodes them with libavcodec.
+ * The packets are handed to a QvkMuxer.
+ *
+ * Timestamps are in milliseconds, the encoder does not care whether the
+ * frames arrive with a fixed rate or not.
+ */
+class QvkEncoder
+{
+public:
+  QvkEncoder();
+  virtual ~QvkEncoder();
+
+  bool open( QvkMuxer *value,
+             QString codecName,
+             int width,
+             int height,
+             int frameRate,
+             QStringList codecOptions,
+             int threads,
+             bool variableFrameRate = false );
+  bool encode( const QvkFrame &frame );
+  bool flush();
+  void close();
+
+  qint64 framesEncoded();
+  qint64 lastPts();
+  QString errorString();
+
+private:
+  AVCodecContext *codecContext;
+  AVStream *stream;
+  AVFrame *picture;
+  SwsContext *swsContext;
+  QvkMuxer *muxer;
+  // Read by the GUI for the metrics while the encoder thread writes them
+  QAtomicInteger<qint64> encodedFrames;
+  QAtomicInteger<qint64> lastTimestamp;
+  QString error;
+
+  AVPixelFormat choosePixelFormat( const AVCodec *codec, QString codecName );
+  bool receivePackets();
+  QString avError( int value );
+
+};
+
+#endif
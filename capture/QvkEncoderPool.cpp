@@ -0,0 +1,219 @@
+#include "QvkEncoderPool.h"
+
+#include <QElapsedTimer>
+#include <QDebug>
+
+QvkEncoderPoolThread::QvkEncoderPoolThread( QvkEncoderPool *value )
+{
+  pool = value;
+}
+
+
+QvkEncoderPoolThread::~QvkEncoderPoolThread()
+{
+}
+
+
+void QvkEncoderPoolThread::run()
+{
+  pool->work();
+}
+
+
+QvkEncoderPool::QvkEncoderPool( int threads )
+{
+  nextIndex = 0;
+  nextId = 1;
+  stopping = false;
+
+  for ( int i = 0; i < qMax( 1, threads ); i++ )
+  {
+    QvkEncoderPoolThread *worker = new QvkEncoderPoolThread( this );
+    workers << worker;
+    worker->start();
+  }
+
+  qDebug().noquote() << "[vokoscreen] [capture] encoder pool with" << workers.count() << "threads";
+}
+
+
+/**
+ * Sessions that are not finished are dropped, waitForFinished() should be called before
+ */
+QvkEncoderPool::~QvkEncoderPool()
+{
+  {
+    QMutexLocker locker( &mutex );
+    stopping = true;
+    workAvailable.wakeAll();
+  }
+
+  foreach ( QvkEncoderPoolThread *worker, workers )
+  {
+    worker->wait();
+    delete worker;
+  }
+
+  qDeleteAll( sessions );
+}
+
+
+int QvkEncoderPool::threadCount()
+{
+  return workers.count();
+}
+
+
+/**
+ * The encoder must be open, the queue reopened. Returns the id of the session.
+ */
+int QvkEncoderPool::add( QvkEncoder *encoder, QvkFrameQueue *queue )
+{
+  QMutexLocker locker( &mutex );
+
+  Session *value = new Session;
+  value->id = nextId++;
+  value->encoder = encoder;
+  value->queue = queue;
+  value->busy = false;
+  value->finished = false;
+  value->busyTime = 0;
+  sessions << value;
+
+  queue->setWakeup( &mutex, &workAvailable );
+  workAvailable.wakeAll();
+  return value->id;
+}
+
+
+/**
+ * Blocks until the queue of the session is closed, all frames are encoded and the encoder is flushed.
+ */
+void QvkEncoderPool::waitForFinished( int id )
+{
+  QMutexLocker locker( &mutex );
+  Session *value = session( id );
+  while ( ( value != NULL ) and ( value->finished == false ) )
+  {
+    sessionFinished.wait( &mutex );
+    value = session( id );
+  }
+}
+
+
+void QvkEncoderPool::remove( int id )
+{
+  QMutexLocker locker( &mutex );
+  Session *value = session( id );
+  if ( value == NULL )
+    return;
+
+  // A worker may still hold the session, e.g. after an error
+  while ( value->busy == true )
+    sessionFinished.wait( &mutex );
+
+  value->queue->setWakeup( NULL, NULL );
+  sessions.removeOne( value );
+  delete value;
+}
+
+
+/**
+ * Time in microseconds the workers have spent in the encoder of the session
+ */
+qint64 QvkEncoderPool::busyTime( int id )
+{
+  QMutexLocker locker( &mutex );
+  Session *value = session( id );
+  if ( value == NULL )
+    return 0;
+
+  return value->busyTime;
+}
+
+
+QvkEncoderPool::Session *QvkEncoderPool::session( int id )
+{
+  foreach ( Session *value, sessions )
+    if ( value->id == id )
+      return value;
+  return NULL;
+}
+
+
+/**
+ * Called with the mutex held. Starts behind the session that was served last.
+ */
+QvkEncoderPool::Session *QvkEncoderPool::nextSession()
+{
+  int count = sessions.count();
+  for ( int i = 0; i < count; i++ )
+  {
+    int index = ( nextIndex + i ) % count;
+    Session *value = sessions.at( index );
+    if ( ( value->busy == true ) or ( value->finished == true ) )
+      continue;
+
+    if ( ( value->queue->count() > 0 ) or ( value->queue->isFinished() == true ) )
+    {
+      nextIndex = index + 1;
+      return value;
+    }
+  }
+  return NULL;
+}
+
+
+/**
+ * The loop of every worker. The queues wake the workers up with the pool mutex,
+ * so a frame pushed between nextSession() and wait() is not missed.
+ */
+void QvkEncoderPool::work()
+{
+  QMutexLocker locker( &mutex );
+  while ( true )
+  {
+    Session *value = nextSession();
+    if ( value == NULL )
+    {
+      if ( stopping == true )
+        return;
+      workAvailable.wait( &mutex );
+      continue;
+    }
+
+    value->busy = true;
+    locker.unlock();
+
+    QElapsedTimer timer;
+    timer.start();
+    QvkFrame frame;
+    bool ok = true;
+    bool finished = false;
+    if ( value->queue->tryPop( &frame ) == true )
+    {
+      ok = value->encoder->encode( frame );
+    }
+    else if ( value->queue->isFinished() == true )
+    {
+      ok = value->encoder->flush();
+      finished = true;
+    }
+    qint64 elapsed = timer.nsecsElapsed() / 1000;
+
+    if ( ok == false )
+    {
+      // close() takes the pool mutex for the wakeup, so not while it is held
+      value->queue->close();
+      finished = true;
+      emit error( value->id, value->encoder->errorString() );
+    }
+
+    locker.relock();
+    value->busy = false;
+    value->busyTime += elapsed;
+    if ( finished == true )
+      value->finished = true;
+    sessionFinished.wakeAll();
+  }
+}
@@ -0,0 +1,90 @@
+#ifndef QvkEncoderPool_H
+#define QvkEncoderPool_H
+
+#include <QObject>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QList>
+
+#include "QvkEncoder.h"
+#include "QvkFrameQueue.h"
+
+class QvkEncoderPool;
+
+/*
+ * One worker of the pool, it has no own state.
+ */
+class QvkEncoderPoolThread: public QThread
+{
+public:
+  QvkEncoderPoolThread( QvkEncoderPool *value );
+  virtual ~QvkEncoderPoolThread();
+
+protected:
+  void run();
+
+private:
+  QvkEncoderPool *pool;
+
+};
+
+
+/*
+ * A fixed number of encoder threads shared by several recordings.
+ *
+ * Every recording is a session with its own encoder and frame queue.
+ * A worker takes one frame of the next session that has work, round robin,
+ * so a busy display can not starve the others. A session is never encoded
+ * by two workers at the same time, the frames keep their order.
+ * Once the queue of a session is closed and empty the encoder is flushed.
+ */
+class QvkEncoderPool: public QObject
+{
+    Q_OBJECT
+
+public:
+  QvkEncoderPool( int threads );
+  virtual ~QvkEncoderPool();
+
+  int threadCount();
+
+  int add( QvkEncoder *encoder, QvkFrameQueue *queue );
+  void waitForFinished( int id );
+  void remove( int id );
+  qint64 busyTime( int id );
+
+
+signals:
+  void error( int id, QString value );
+
+
+private:
+  struct Session
+  {
+    int id;
+    QvkEncoder *encoder;
+    QvkFrameQueue *queue;
+    bool busy;
+    bool finished;
+    qint64 busyTime; // microseconds
+  };
+
+  QList<QvkEncoderPoolThread*> workers;
+  QList<Session*> sessions;
+  QMutex mutex;
+  QWaitCondition workAvailable;
+  QWaitCondition sessionFinished;
+  int nextIndex;
+  int nextId;
+  bool stopping;
+
+  Session *session( int id );
+  Session *nextSession();
+  void work();
+
+  friend class QvkEncoderPoolThread;
+
+};
+
+#endif
@@ -0,0 +1,46 @@
+#include "QvkEncoderThread.h"
+
+#include <QElapsedTimer>
+
+QvkEncoderThread::QvkEncoderThread( QvkEncoder *encoder, QvkFrameQueue *queue )
+{
+  frameEncoder = encoder;
+  frameQueue = queue;
+  busy = 0;
+}
+
+
+QvkEncoderThread::~QvkEncoderThread()
+{
+}
+
+
+/**
+ * Time in microseconds the thread has spent in the encoder, the waiting for frames is not counted
+ */
+qint64 QvkEncoderThread::busyTime()
+{
+  return busy;
+}
+
+
+void QvkEncoderThread::run()
+{
+  QvkFrame frame;
+  QElapsedTimer timer;
+  while ( frameQueue->pop( &frame ) )
+  {
+    timer.start();
+    bool ok = frameEncoder->encode( frame );
+    busy.fetchAndAddRelaxed( timer.nsecsElapsed() / 1000 );
+    if ( ok == false )
+    {
+      emit error( frameEncoder->errorString() );
+      frameQueue->close();
+      return;
+    }
+  }
+
+  if ( frameEncoder->flush() == false )
+    emit error( frameEncoder->errorString() );
+}
@@ -0,0 +1,39 @@
+#ifndef QvkEncoderThread_H
+#define QvkEncoderThread_H
+
+#include <QThread>
+#include <QAtomicInteger>
+
+#include "QvkEncoder.h"
+#include "QvkFrameQueue.h"
+
+/*
+ * Takes the frames out of the queue and encodes them until the queue is closed.
+ */
+class QvkEncoderThread: public QThread
+{
+    Q_OBJECT
+
+public:
+  QvkEncoderThread( QvkEncoder *encoder, QvkFrameQueue *queue );
+  virtual ~QvkEncoderThread();
+
+  qint64 busyTime();
+
+
+signals:
+  void error( QString value );
+
+
+protected:
+  void run();
+
+
+private:
+  QvkEncoder *frameEncoder;
+  QvkFrameQueue *frameQueue;
+  QAtomicInteger<qint64> busy;
+
+};
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef QvkFrame_H
+#define QvkFrame_H
+
+#include <QByteArray>
+#include <QMetaType>
+
+/*
+ * A captured picture in BGRA byte order as delivered by XShmGetImage.
+ * data is implicitly shared, handing a frame from the capture thread
+ * to the encoder thread does not copy the pixels.
+ */
+struct QvkFrame
+{
+  QByteArray data;
+  int width = 0;
+  int height = 0;
+  int stride = 0;
+  qint64 pts = 0; // Milliseconds since begin of recording
+};
+
+Q_DECLARE_METATYPE( QvkFrame )
+
+#endif
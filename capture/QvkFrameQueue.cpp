@@ -0,0 +1,145 @@
+#include "QvkFrameQueue.h"
+
+QvkFrameQueue::QvkFrameQueue( int value )
+{
+  maxCount = value;
+  droppedFrames = 0;
+  closed = false;
+  wakeupMutex = NULL;
+  wakeupCondition = NULL;
+}
+
+
+QvkFrameQueue::~QvkFrameQueue()
+{
+}
+
+
+/**
+ * Returns false if the queue is full or closed, the frame is then dropped
+ */
+bool QvkFrameQueue::push( const QvkFrame &frame )
+{
+  {
+    QMutexLocker locker( &mutex );
+    if ( closed == true )
+      return false;
+
+    if ( queue.count() >= maxCount )
+    {
+      droppedFrames++;
+      return false;
+    }
+
+    queue.enqueue( frame );
+    notEmpty.wakeOne();
+  }
+
+  wakeup();
+  return true;
+}
+
+
+/**
+ * Blocks until a frame is available.
+ * Returns false if the queue is closed and all frames are taken.
+ */
+bool QvkFrameQueue::pop( QvkFrame *frame )
+{
+  QMutexLocker locker( &mutex );
+  while ( queue.isEmpty() )
+  {
+    if ( closed == true )
+      return false;
+    notEmpty.wait( &mutex );
+  }
+
+  *frame = queue.dequeue();
+  return true;
+}
+
+
+/**
+ * Does not block, returns false if no frame is available
+ */
+bool QvkFrameQueue::tryPop( QvkFrame *frame )
+{
+  QMutexLocker locker( &mutex );
+  if ( queue.isEmpty() )
+    return false;
+
+  *frame = queue.dequeue();
+  return true;
+}
+
+
+void QvkFrameQueue::close()
+{
+  {
+    QMutexLocker locker( &mutex );
+    closed = true;
+    notEmpty.wakeAll();
+  }
+
+  wakeup();
+}
+
+
+/**
+ * The own mutex is not held while the wakeup mutex is locked,
+ * a pool may call count() or tryPop() with its mutex held.
+ */
+void QvkFrameQueue::setWakeup( QMutex *poolMutex, QWaitCondition *poolCondition )
+{
+  wakeupMutex = poolMutex;
+  wakeupCondition = poolCondition;
+}
+
+
+void QvkFrameQueue::wakeup()
+{
+  if ( wakeupCondition == NULL )
+    return;
+
+  QMutexLocker locker( wakeupMutex );
+  wakeupCondition->wakeOne();
+}
+
+
+/**
+ * Closed and all frames are taken
+ */
+bool QvkFrameQueue::isFinished()
+{
+  QMutexLocker locker( &mutex );
+  return ( closed == true ) and queue.isEmpty();
+}
+
+
+void QvkFrameQueue::reopen()
+{
+  QMutexLocker locker( &mutex );
+  queue.clear();
+  droppedFrames = 0;
+  closed = false;
+}
+
+
+int QvkFrameQueue::count()
+{
+  QMutexLocker locker( &mutex );
+  return queue.count();
+}
+
+
+int QvkFrameQueue::capacity()
+{
+  return maxCount;
+}
+
+
+int QvkFrameQueue::dropped()
+{
+  QMutexLocker locker( &mutex );
+  return droppedFrames;
+}
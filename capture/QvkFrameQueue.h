@@ -0,0 +1,51 @@
+#ifndef QvkFrameQueue_H
+#define QvkFrameQueue_H
+
+#include <QMutex>
+#include <QWaitCondition>
+#include <QQueue>
+
+#include "QvkFrame.h"
+
+/*
+ * Bounded queue between capture thread and encoder thread.
+ * If the encoder falls behind, new frames are dropped and counted
+ * instead of letting the memory grow without limit.
+ *
+ * With setWakeup() a shared encoder pool is woken up after every push
+ * and at close, instead of a thread waiting in pop().
+ */
+class QvkFrameQueue
+{
+public:
+  QvkFrameQueue( int value );
+  virtual ~QvkFrameQueue();
+
+  bool push( const QvkFrame &frame );
+  bool pop( QvkFrame *frame );
+  bool tryPop( QvkFrame *frame );
+  void close();
+  void reopen();
+  void setWakeup( QMutex *poolMutex, QWaitCondition *poolCondition );
+
+  bool isFinished();
+
+  int count();
+  int capacity();
+  int dropped();
+
+private:
+  QMutex mutex;
+  QWaitCondition notEmpty;
+  QQueue<QvkFrame> queue;
+  int maxCount;
+  int droppedFrames;
+  bool closed;
+  QMutex *wakeupMutex;
+  QWaitCondition *wakeupCondition;
+
+  void wakeup();
+
+};
+
+#endif
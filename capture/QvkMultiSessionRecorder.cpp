@@ -0,0 +1,255 @@
+#include "QvkMultiSessionRecorder.h"
+
+#include <QDebug>
+
+QvkMultiSessionRecorder::QvkMultiSessionRecorder( int encoderThreads )
+{
+  runningCount = 0;
+  pausing = false;
+  trackMuxer = NULL;
+  pool = ( encoderThreads > 0 ) ? new QvkEncoderPool( encoderThreads ) : NULL;
+}
+
+
+QvkMultiSessionRecorder::~QvkMultiSessionRecorder()
+{
+  stop();
+  release();
+  delete pool;
+}
+
+
+/**
+ * An empty fileName gives one file per session again
+ */
+void QvkMultiSessionRecorder::setTrackFile( QString fileName, QString format )
+{
+  trackFileName = fileName;
+  trackFormat = format;
+}
+
+
+int QvkMultiSessionRecorder::count()
+{
+  return controllers.count();
+}
+
+
+bool QvkMultiSessionRecorder::isRunning()
+{
+  return runningCount > 0;
+}
+
+
+/**
+ * The errors of all sessions, one line per session
+ */
+QString QvkMultiSessionRecorder::errorString()
+{
+  return lastError;
+}
+
+
+/**
+ * The controllers close their encoders when they are deleted,
+ * so the file with the tracks is closed after them.
+ */
+void QvkMultiSessionRecorder::release()
+{
+  qDeleteAll( controllers );
+  controllers.clear();
+
+  if ( trackMuxer != NULL )
+  {
+    trackMuxer->close();
+    delete trackMuxer;
+    trackMuxer = NULL;
+  }
+}
+
+
+/**
+ * All sessions start or none. Every session is prepared first, the tracks
+ * must be known before the header of a shared file is written.
+ * The encoder threads of the settings should be 1 with a pool, the pool gives the parallelism.
+ */
+bool QvkMultiSessionRecorder::start( QList<QvkCaptureSettings> list )
+{
+  if ( isRunning() == true )
+    return false;
+
+  release();
+  sessionSettings = list;
+  lastMetrics.clear();
+  lastError.clear();
+  pausing = false;
+
+  if ( trackFileName > "" )
+  {
+    trackMuxer = new QvkMuxer();
+    if ( trackMuxer->open( trackFileName, trackFormat ) == false )
+    {
+      lastError = trackMuxer->errorString();
+      release();
+      return false;
+    }
+  }
+
+  for ( int i = 0; i < list.count(); i++ )
+  {
+    QvkCaptureController *controller = new QvkCaptureController( pool, trackMuxer );
+    controllers << controller;
+    lastMetrics << QvkEncoderMetrics();
+
+    if ( controller->prepare( list.at( i ) ) == false )
+    {
+      lastError = list.at( i ).display + ": " + controller->errorString();
+      release();
+      return false;
+    }
+  }
+
+  if ( ( trackMuxer != NULL ) and ( trackMuxer->writeHeader() == false ) )
+  {
+    lastError = trackMuxer->errorString();
+    release();
+    return false;
+  }
+
+  foreach ( QvkCaptureController *controller, controllers )
+  {
+    connect( controller, SIGNAL( stopped() ), this, SLOT( controllerStopped() ) );
+    connect( controller, SIGNAL( metrics( QvkEncoderMetrics ) ), this, SLOT( controllerMetrics( QvkEncoderMetrics ) ) );
+    controller->begin();
+    runningCount++;
+  }
+
+  qDebug().noquote() << "[vokoscreen] [capture]" << controllers.count() << "sessions with"
+                     << ( ( pool != NULL ) ? QString::number( pool->threadCount() ) : "own" ) << "encoder threads";
+  emit started();
+  return true;
+}
+
+
+/**
+ * All sessions are paused first, so every file ends at the same moment
+ * and not one after the other while the encoders are flushed.
+ */
+void QvkMultiSessionRecorder::stop()
+{
+  foreach ( QvkCaptureController *controller, controllers )
+    controller->pause();
+
+  foreach ( QvkCaptureController *controller, controllers )
+    controller->stop();
+}
+
+
+void QvkMultiSessionRecorder::pause()
+{
+  if ( ( isRunning() == false ) or ( pausing == true ) )
+    return;
+
+  foreach ( QvkCaptureController *controller, controllers )
+    controller->pause();
+
+  pausing = true;
+  emit paused();
+}
+
+
+void QvkMultiSessionRecorder::resume()
+{
+  if ( ( isRunning() == false ) or ( pausing == false ) )
+    return;
+
+  foreach ( QvkCaptureController *controller, controllers )
+    controller->resume();
+
+  pausing = false;
+  emit resumed();
+}
+
+
+/**
+ * All sessions together, e.g. from the adaptive quality
+ */
+void QvkMultiSessionRecorder::setFrameRate( int value )
+{
+  foreach ( QvkCaptureController *controller, controllers )
+    controller->setFrameRate( value );
+}
+
+
+/**
+ * The tracks of a shared file end together, one failed track stops all.
+ */
+void QvkMultiSessionRecorder::controllerStopped()
+{
+  QvkCaptureController *controller = qobject_cast<QvkCaptureController*>( sender() );
+  int session = controllers.indexOf( controller );
+  if ( session < 0 )
+    return;
+
+  QString error = controller->errorString();
+  if ( error > "" )
+  {
+    if ( lastError > "" )
+      lastError += "\n";
+    lastError += sessionSettings.at( session ).display + ": " + error;
+  }
+
+  // stop() below comes back here for the other sessions, the last one finishes
+  runningCount--;
+  bool last = ( runningCount == 0 );
+  emit sessionStopped( session, error );
+
+  if ( ( error > "" ) and ( trackMuxer != NULL ) )
+    stop();
+
+  if ( last == true )
+  {
+    if ( trackMuxer != NULL )
+      trackMuxer->close();
+    pausing = false;
+    emit stopped();
+  }
+}
+
+
+/**
+ * The total is sent with the report of the first session: the slowest
+ * session gives fps and speed, the dropped frames and the sizes are added.
+ * All tracks of a shared file report the size of the whole file.
+ */
+void QvkMultiSessionRecorder::controllerMetrics( QvkEncoderMetrics value )
+{
+  QvkCaptureController *controller = qobject_cast<QvkCaptureController*>( sender() );
+  int session = controllers.indexOf( controller );
+  if ( session < 0 )
+    return;
+
+  lastMetrics[ session ] = value;
+  emit metrics( session, value );
+
+  if ( session != 0 )
+    return;
+
+  QvkEncoderMetrics total = value;
+  for ( int i = 1; i < lastMetrics.count(); i++ )
+  {
+    const QvkEncoderMetrics &other = lastMetrics.at( i );
+    total.frame = qMin( total.frame, other.frame );
+    total.fps = qMin( total.fps, other.fps );
+    total.speed = qMin( total.speed, other.speed );
+    total.outTime = qMin( total.outTime, other.outTime );
+    total.dropFrames += other.dropFrames;
+    total.dupFrames += other.dupFrames;
+    if ( trackMuxer == NULL )
+    {
+      total.totalSize += other.totalSize;
+      total.bitrate += other.bitrate;
+    }
+  }
+  emit totalMetrics( total );
+}
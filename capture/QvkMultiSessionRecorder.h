@@ -0,0 +1,74 @@
+#ifndef QvkMultiSessionRecorder_H
+#define QvkMultiSessionRecorder_H
+
+#include <QObject>
+#include <QList>
+
+#include "QvkCaptureController.h"
+#include "QvkEncoderPool.h"
+#include "QvkMuxer.h"
+
+/*
+ * Records several rectangles at once in one process, e.g. a row of Xvfb
+ * servers on a test machine or every monitor of a desktop on its own.
+ * Every session has its own capture thread. With encoderThreads > 0 the
+ * encoding is done by one QvkEncoderPool with a fixed number of threads,
+ * with 0 every session has its own encoder thread.
+ *
+ * With setTrackFile() all sessions are tracks of one file, otherwise every
+ * session writes the file of its settings.
+ */
+class QvkMultiSessionRecorder: public QObject
+{
+    Q_OBJECT
+
+public:
+  QvkMultiSessionRecorder( int encoderThreads );
+  virtual ~QvkMultiSessionRecorder();
+
+  void setTrackFile( QString fileName, QString format );
+  int count();
+  bool isRunning();
+  QString errorString();
+
+
+public slots:
+  bool start( QList<QvkCaptureSettings> list );
+  void stop();
+  void pause();
+  void resume();
+  void setFrameRate( int value );
+
+
+signals:
+  void started();
+  void stopped();
+  void paused();
+  void resumed();
+  void sessionStopped( int session, QString error );
+  void metrics( int session, QvkEncoderMetrics value );
+  void totalMetrics( QvkEncoderMetrics value );
+
+
+private slots:
+  void controllerStopped();
+  void controllerMetrics( QvkEncoderMetrics value );
+
+
+private:
+  QvkEncoderPool *pool;
+  QvkMuxer *trackMuxer;
+  QString trackFileName;
+  QString trackFormat;
+  QList<QvkCaptureController*> controllers;
+  QList<QvkCaptureSettings> sessionSettings;
+  QList<QvkEncoderMetrics> lastMetrics;
+  int runningCount;
+  bool pausing;
+  QString lastError;
+
+  void release();
+
+};
+
+#endif
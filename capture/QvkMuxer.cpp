@@ -0,0 +1,168 @@
+#include "QvkMuxer.h"
+
+#include <QDebug>
+
+QvkMuxer::QvkMuxer()
+{
+  formatContext = NULL;
+  headerWritten = false;
+}
+
+
+QvkMuxer::~QvkMuxer()
+{
+  close();
+}
+
+
+QString QvkMuxer::avError( int value )
+{
+  char buffer[ AV_ERROR_MAX_STRING_SIZE ] = { 0 };
+  av_strerror( value, buffer, sizeof( buffer ) );
+  return QString::fromLocal8Bit( buffer );
+}
+
+
+/**
+ * formatName: is the ffmpeg muxer name matroska, webm, mp4, gif, mov
+ */
+bool QvkMuxer::open( QString fileName, QString formatName )
+{
+  close();
+
+#if LIBAVFORMAT_VERSION_INT < AV_VERSION_INT( 58, 9, 100 )
+  av_register_all();
+#endif
+
+  name = fileName;
+  int ret = avformat_alloc_output_context2( &formatContext, NULL, formatName.toLatin1().constData(), fileName.toLocal8Bit().constData() );
+  if ( ret < 0 )
+  {
+    error = "Can not create " + formatName + " muxer: " + avError( ret );
+    formatContext = NULL;
+    return false;
+  }
+
+  ret = avio_open( &formatContext->pb, fileName.toLocal8Bit().constData(), AVIO_FLAG_WRITE );
+  if ( ret < 0 )
+  {
+    error = "Can not open " + fileName + ": " + avError( ret );
+    avformat_free_context( formatContext );
+    formatContext = NULL;
+    return false;
+  }
+
+  return true;
+}
+
+
+AVStream *QvkMuxer::addStream( AVCodecContext *codecContext )
+{
+  AVStream *stream = avformat_new_stream( formatContext, NULL );
+  if ( stream == NULL )
+  {
+    error = "Can not create stream";
+    return NULL;
+  }
+
+  avcodec_parameters_from_context( stream->codecpar, codecContext );
+  stream->time_base = codecContext->time_base;
+  stream->avg_frame_rate = codecContext->framerate;
+  return stream;
+}
+
+
+bool QvkMuxer::needsGlobalHeader()
+{
+  return ( formatContext->oformat->flags & AVFMT_GLOBALHEADER );
+}
+
+
+/**
+ * The file is written so that each part of it can be played, also if vokoscreen
+ * crashes: mp4 and mov in fragments without a moov atom at the end, matroska
+ * and webm with a new cluster every second.
+ */
+bool QvkMuxer::writeHeader()
+{
+  QMutexLocker locker( &mutex );
+
+  AVDictionary *options = NULL;
+  QString formatName = formatContext->oformat->name;
+  if ( formatName.contains( "mp4" ) or formatName.contains( "mov" ) )
+  {
+    av_dict_set( &options, "movflags", "frag_keyframe+empty_moov+default_base_moof", 0 );
+    av_dict_set( &options, "frag_duration", "1000000", 0 );
+  }
+  if ( formatName.contains( "matroska" ) or formatName.contains( "webm" ) )
+  {
+    av_dict_set( &options, "cluster_time_limit", "1000", 0 );
+  }
+  formatContext->flags |= AVFMT_FLAG_FLUSH_PACKETS;
+
+  int ret = avformat_write_header( formatContext, &options );
+  av_dict_free( &options );
+  if ( ret < 0 )
+  {
+    error = "Can not write header: " + avError( ret );
+    return false;
+  }
+  headerWritten = true;
+  return true;
+}
+
+
+bool QvkMuxer::writePacket( AVPacket *packet )
+{
+  QMutexLocker locker( &mutex );
+  int ret = av_interleaved_write_frame( formatContext, packet );
+  if ( ret < 0 )
+  {
+    error = "Can not write packet: " + avError( ret );
+    return false;
+  }
+  return true;
+}
+
+
+void QvkMuxer::close()
+{
+  QMutexLocker locker( &mutex );
+  if ( formatContext == NULL )
+    return;
+
+  if ( headerWritten == true )
+    av_write_trailer( formatContext );
+
+  avio_closep( &formatContext->pb );
+  avformat_free_context( formatContext );
+  formatContext = NULL;
+  headerWritten = false;
+}
+
+
+bool QvkMuxer::isOpen()
+{
+  return ( formatContext != NULL );
+}
+
+
+qint64 QvkMuxer::bytesWritten()
+{
+  QMutexLocker locker( &mutex );
+  if ( ( formatContext == NULL ) or ( formatContext->pb == NULL ) )
+    return 0;
+  return avio_tell( formatContext->pb );
+}
+
+
+QString QvkMuxer::fileName()
+{
+  return name;
+}
+
+
+QString QvkMuxer::errorString()
+{
+  return error;
+}
@@ -0,0 +1,46 @@
+#ifndef QvkMuxer_H
+#define QvkMuxer_H
+
+#include <QString>
+#include <QMutex>
+
+extern "C"
+{
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+}
+
+/*
+ * Writes encoded packets into a container file with libavformat.
+ * writePacket() is thread safe, so several encoders may share one file.
+ */
+class QvkMuxer
+{
+public:
+  QvkMuxer();
+  virtual ~QvkMuxer();
+
+  bool open( QString fileName, QString formatName );
+  AVStream *addStream( AVCodecContext *codecContext );
+  bool writeHeader();
+  bool writePacket( AVPacket *packet );
+  void close();
+
+  bool isOpen();
+  bool needsGlobalHeader();
+  qint64 bytesWritten();
+  QString fileName();
+  QString errorString();
+
+private:
+  AVFormatContext *formatContext;
+  QMutex mutex;
+  bool headerWritten;
+  QString name;
+  QString error;
+
+  QString avError( int value );
+
+};
+
+#endif
@@ -0,0 +1,838 @@
+#include "QvkShmGrabber.h"
+
+#include <QDebug>
+#include <QAtomicInt>
+
+#include <X11/extensions/Xfixes.h>
+#include <X11/extensions/Xcomposite.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <string.h>
+
+/*
+ * A recorded window can be destroyed or unmapped at any time, the requests on
+ * it then fail with BadWindow, BadDrawable or BadMatch. The default handler
+ * of Xlib would end the process. The handler is global, errors of other
+ * threads and other connections are passed to the handler installed before.
+ */
+static XErrorHandler previousErrorHandler = NULL;
+static QAtomicInt errorHandlerInstalled;
+static thread_local int trappedError = -1;
+
+static int trapErrorHandler( Display *display, XErrorEvent *event )
+{
+  if ( trappedError >= 0 )
+  {
+    trappedError = event->error_code;
+    return 0;
+  }
+
+  if ( previousErrorHandler != NULL )
+    return previousErrorHandler( display, event );
+  return 0;
+}
+
+static void trapErrors()
+{
+  if ( errorHandlerInstalled.testAndSetOrdered( 0, 1 ) )
+    previousErrorHandler = XSetErrorHandler( trapErrorHandler );
+  trappedError = 0;
+}
+
+/**
+ * Returns true if a request since trapErrors() has failed
+ */
+static bool untrapErrors( Display *display )
+{
+  XSync( display, False );
+  int value = trappedError;
+  trappedError = -1;
+  return ( value != 0 );
+}
+
+QvkShmGrabber::QvkShmGrabber()
+{
+  display = NULL;
+  root = 0;
+  window = 0;
+  pixmap = 0;
+  pixmapWidth = 0;
+  pixmapHeight = 0;
+  pixmapStale = false;
+  windowMapped = false;
+  windowGone = false;
+  image = NULL;
+  tile = NULL;
+  changed = false;
+  shmAttached = false;
+  haveXfixes = false;
+  xfixesEventBase = 0;
+  damage = 0;
+  damageEventBase = 0;
+  damagePending = false;
+  cursorPending = false;
+  lastCursorX = -1;
+  lastCursorY = -1;
+  originX = 0;
+  originY = 0;
+  shmInfo.shmid = -1;
+  shmInfo.shmaddr = NULL;
+}
+
+
+QvkShmGrabber::~QvkShmGrabber()
+{
+  close();
+}
+
+
+/**
+ * displayName: is :0, :1 etc.
+ * width, height: size of the grabbed rectangle, this is also the size of the shared memory segment
+ * windowId: the window to record, 0 for a rectangle of the root window
+ */
+bool QvkShmGrabber::open( QString displayName, int width, int height, unsigned long windowId )
+{
+  close();
+
+  display = XOpenDisplay( displayName.toLocal8Bit().constData() );
+  if ( display == NULL )
+  {
+    error = "Can not open display " + displayName;
+    return false;
+  }
+
+  if ( XShmQueryExtension( display ) == False )
+  {
+    error = "The X server has no MIT-SHM extension";
+    close();
+    return false;
+  }
+
+  int screen = DefaultScreen( display );
+  root = RootWindow( display, screen );
+
+  // The images must have the depth of the window, e.g. 32 for windows with alpha channel
+  Visual *visual = DefaultVisual( display, screen );
+  int depth = DefaultDepth( display, screen );
+  if ( ( windowId != 0 ) and ( openWindow( windowId, &visual, &depth ) == false ) )
+  {
+    close();
+    return false;
+  }
+
+  image = XShmCreateImage( display,
+                           visual,
+                           depth,
+                           ZPixmap,
+                           NULL,
+                           &shmInfo,
+                           width,
+                           height );
+  if ( image == NULL )
+  {
+    error = "XShmCreateImage failed";
+    close();
+    return false;
+  }
+
+  if ( image->bits_per_pixel != 32 )
+  {
+    error = "Only 32 bit per pixel visuals are supported, found " + QString::number( image->bits_per_pixel );
+    close();
+    return false;
+  }
+
+  // Second image header on the same segment, width and height are set for every damaged rectangle
+  tile = XShmCreateImage( display,
+                          visual,
+                          depth,
+                          ZPixmap,
+                          NULL,
+                          &shmInfo,
+                          width,
+                          height );
+  if ( tile == NULL )
+  {
+    error = "XShmCreateImage failed";
+    close();
+    return false;
+  }
+
+  shmInfo.shmid = shmget( IPC_PRIVATE, image->bytes_per_line * image->height, IPC_CREAT | 0600 );
+  if ( shmInfo.shmid == -1 )
+  {
+    error = "shmget failed";
+    close();
+    return false;
+  }
+
+  shmInfo.shmaddr = image->data = tile->data = (char *)shmat( shmInfo.shmid, NULL, 0 );
+  shmInfo.readOnly = False;
+  if ( shmInfo.shmaddr == (char *)-1 )
+  {
+    shmInfo.shmaddr = image->data = tile->data = NULL;
+    error = "shmat failed";
+    close();
+    return false;
+  }
+
+  if ( XShmAttach( display, &shmInfo ) == False )
+  {
+    error = "XShmAttach failed";
+    close();
+    return false;
+  }
+  XSync( display, False );
+  shmAttached = true;
+
+  // The segment is removed by the kernel as soon as both sides are detached,
+  // also if vokoscreen crashes.
+  shmctl( shmInfo.shmid, IPC_RMID, NULL );
+
+  int errorBase;
+  haveXfixes = XFixesQueryExtension( display, &xfixesEventBase, &errorBase );
+
+  qDebug().noquote() << "[vokoscreen] [capture] XShm segment" << width << "x" << height
+                     << "with" << image->bytes_per_line * image->height / 1024 << "KB on display" << displayName;
+  return true;
+}
+
+
+/**
+ * Redirects the window into its own pixmap. With CompositeRedirectAutomatic the
+ * X server still draws the window on the screen, a running compositing manager
+ * keeps its own redirection.
+ */
+bool QvkShmGrabber::openWindow( unsigned long windowId, Visual **visual, int *depth )
+{
+  int eventBase, errorBase;
+  int major = 0;
+  int minor = 2;
+  if ( ( XCompositeQueryExtension( display, &eventBase, &errorBase ) == False ) or
+       ( XCompositeQueryVersion( display, &major, &minor ) == 0 ) or
+       ( ( major == 0 ) and ( minor < 2 ) ) )
+  {
+    error = "The X server has no Composite extension 0.2";
+    return false;
+  }
+
+  XWindowAttributes attributes;
+  trapErrors();
+  Status status = XGetWindowAttributes( display, windowId, &attributes );
+  if ( untrapErrors( display ) or ( status == 0 ) )
+  {
+    error = "The window " + QString::number( windowId, 16 ) + " does not exist";
+    return false;
+  }
+
+  window = windowId;
+  *visual = attributes.visual;
+  *depth = attributes.depth;
+  windowMapped = ( attributes.map_state == IsViewable );
+  windowGone = false;
+  pixmapStale = true;
+
+  trapErrors();
+  XSelectInput( display, window, StructureNotifyMask );
+  XCompositeRedirectWindow( display, window, CompositeRedirectAutomatic );
+  if ( untrapErrors( display ) )
+  {
+    error = "XCompositeRedirectWindow failed";
+    window = 0;
+    return false;
+  }
+
+  qDebug().noquote() << "[vokoscreen] [capture] window" << QString::number( windowId, 16 ) << "with XComposite, depth" << *depth;
+  return true;
+}
+
+
+/**
+ * A new pixmap is needed after every resize and every map of the window.
+ */
+bool QvkShmGrabber::namePixmap()
+{
+  if ( pixmap != 0 )
+  {
+    trapErrors();
+    XFreePixmap( display, pixmap );
+    untrapErrors( display );
+    pixmap = 0;
+  }
+
+  Window rootReturn;
+  int x, y;
+  unsigned int width, height, border, depth;
+  trapErrors();
+  Pixmap value = XCompositeNameWindowPixmap( display, window );
+  Status status = XGetGeometry( display, value, &rootReturn, &x, &y, &width, &height, &border, &depth );
+  if ( untrapErrors( display ) or ( status == 0 ) )
+    return false;
+
+  pixmap = value;
+  pixmapWidth = width;
+  pixmapHeight = height;
+  pixmapStale = false;
+  return true;
+}
+
+
+void QvkShmGrabber::close()
+{
+  if ( window != 0 )
+  {
+    trapErrors();
+    if ( pixmap != 0 )
+      XFreePixmap( display, pixmap );
+    XCompositeUnredirectWindow( display, window, CompositeRedirectAutomatic );
+    untrapErrors( display );
+    pixmap = 0;
+    window = 0;
+    pixmapWidth = 0;
+    pixmapHeight = 0;
+  }
+
+  if ( damage != 0 )
+  {
+    XDamageDestroy( display, damage );
+    damage = 0;
+    damagePending = false;
+    cursorPending = false;
+    damageList.clear();
+  }
+
+  if ( shmAttached == true )
+  {
+    XShmDetach( display, &shmInfo );
+    XSync( display, False );
+    shmAttached = false;
+  }
+
+  if ( shmInfo.shmaddr != NULL )
+  {
+    shmdt( shmInfo.shmaddr );
+    shmInfo.shmaddr = NULL;
+  }
+
+  if ( image != NULL )
+  {
+    // The data belongs to the shared memory segment and is already detached
+    image->data = NULL;
+    XDestroyImage( image );
+    image = NULL;
+  }
+
+  if ( tile != NULL )
+  {
+    tile->data = NULL;
+    XDestroyImage( tile );
+    tile = NULL;
+  }
+
+  buffer.clear();
+  cursorRect = QRect();
+  cursorUnder.clear();
+  changed = false;
+
+  if ( display != NULL )
+  {
+    XCloseDisplay( display );
+    display = NULL;
+  }
+}
+
+
+bool QvkShmGrabber::isOpen()
+{
+  return ( image != NULL );
+}
+
+
+/**
+ * Grab the whole rectangle with the upper left corner x, y into the frame buffer.
+ * The rectangle is moved back into the screen if it is partially outside,
+ * otherwise the X server would answer with BadMatch.
+ */
+bool QvkShmGrabber::grab( int x, int y )
+{
+  originX = qBound( 0, x, qMax( 0, screenWidth() - image->width ) );
+  originY = qBound( 0, y, qMax( 0, screenHeight() - image->height ) );
+
+  if ( XShmGetImage( display, root, image, originX, originY, AllPlanes ) == False )
+  {
+    error = "XShmGetImage failed";
+    return false;
+  }
+
+  int stride = bytesPerLine();
+  buffer.resize( stride * image->height );
+  uchar *dst = (uchar *)buffer.data();
+  if ( stride == image->bytes_per_line )
+  {
+    memcpy( dst, image->data, buffer.size() );
+  }
+  else
+  {
+    for ( int row = 0; row < image->height; row++ )
+      memcpy( dst + row * stride, image->data + row * image->bytes_per_line, stride );
+  }
+
+  // The cursor was overwritten
+  cursorRect = QRect();
+  return true;
+}
+
+
+/**
+ * Grab one rectangle, relative to the origin, into the segment and copy it to its place in the frame buffer.
+ */
+bool QvkShmGrabber::grabTile( const QRect &rect )
+{
+  tile->width = rect.width();
+  tile->height = rect.height();
+  tile->bytes_per_line = rect.width() * 4;
+
+  if ( window != 0 )
+  {
+    // The pixmap may be gone with the window, this is no error of the recording
+    trapErrors();
+    Status status = XShmGetImage( display, pixmap, tile, rect.x(), rect.y(), AllPlanes );
+    if ( untrapErrors( display ) or ( status == False ) )
+    {
+      pixmapStale = true;
+      return false;
+    }
+  }
+  else if ( XShmGetImage( display, root, tile, originX + rect.x(), originY + rect.y(), AllPlanes ) == False )
+  {
+    error = "XShmGetImage failed";
+    return false;
+  }
+
+  int stride = bytesPerLine();
+  uchar *dst = (uchar *)buffer.data() + rect.y() * stride + rect.x() * 4;
+  for ( int row = 0; row < rect.height(); row++ )
+    memcpy( dst + row * stride, tile->data + row * tile->bytes_per_line, tile->bytes_per_line );
+
+  return true;
+}
+
+
+/**
+ * Bring the frame buffer up to date.
+ * Without damage or if the origin has moved the whole rectangle is grabbed.
+ * With damage only the damaged rectangles, or the whole rectangle if more than
+ * the half is damaged, one XShmGetImage is then cheaper than many small ones.
+ * isChanged() tells whether the content has changed.
+ */
+bool QvkShmGrabber::update( int x, int y )
+{
+  if ( image == NULL )
+    return false;
+
+  restoreCursor();
+
+  if ( window != 0 )
+    return updateWindow();
+
+  int newX = qBound( 0, x, qMax( 0, screenWidth() - image->width ) );
+  int newY = qBound( 0, y, qMax( 0, screenHeight() - image->height ) );
+
+  // Must always be called, it resets the damage
+  bool damaged = isDamaged( x, y );
+
+  if ( ( damage == 0 ) or buffer.isEmpty() or ( newX != originX ) or ( newY != originY ) )
+  {
+    changed = true;
+    return grab( x, y );
+  }
+
+  changed = damaged;
+  if ( damaged == false )
+    return true;
+
+  qint64 area = 0;
+  for ( int i = 0; i < damageList.count(); i++ )
+    area += (qint64)damageList[ i ].width() * damageList[ i ].height();
+
+  if ( area * 2 > (qint64)image->width * image->height )
+    return grab( x, y );
+
+  for ( int i = 0; i < damageList.count(); i++ )
+  {
+    if ( grabTile( damageList[ i ] ) == false )
+      return false;
+  }
+  return true;
+}
+
+
+/**
+ * Like update() but from the pixmap of the window. The origin is the position
+ * of the window on the screen, it is only needed for the cursor.
+ * A failed grab is not an error, the window was unmapped or destroyed in
+ * between, the last picture is kept until the window is back.
+ */
+bool QvkShmGrabber::updateWindow()
+{
+  changed = false;
+
+  // The encoder needs a picture also if the window was never visible
+  if ( buffer.isEmpty() )
+    buffer.fill( 0, bytesPerLine() * image->height );
+
+  // Must always be called, it resets the damage
+  bool damaged = isDamaged( 0, 0 );
+
+  if ( ( windowGone == true ) or ( windowMapped == false ) )
+    return true;
+
+  Window child;
+  trapErrors();
+  XTranslateCoordinates( display, window, root, 0, 0, &originX, &originY, &child );
+  untrapErrors( display );
+
+  if ( pixmapStale == true )
+  {
+    if ( namePixmap() == false )
+      return true;
+    grabWindow();
+    return true;
+  }
+
+  if ( ( damage == 0 ) or buffer.isEmpty() )
+  {
+    grabWindow();
+    return true;
+  }
+
+  if ( damaged == false )
+    return true;
+
+  qint64 area = 0;
+  for ( int i = 0; i < damageList.count(); i++ )
+    area += (qint64)damageList[ i ].width() * damageList[ i ].height();
+
+  if ( area * 2 > (qint64)image->width * image->height )
+  {
+    grabWindow();
+    return true;
+  }
+
+  for ( int i = 0; i < damageList.count(); i++ )
+  {
+    if ( grabTile( damageList[ i ] ) == false )
+      return true;
+  }
+  changed = true;
+  return true;
+}
+
+
+/**
+ * The whole window. If the window is smaller than the recorded size, the rest is black.
+ */
+bool QvkShmGrabber::grabWindow()
+{
+  int stride = bytesPerLine();
+  buffer.resize( stride * image->height );
+
+  QRect rect = QRect( 0, 0, image->width, image->height ).intersected( QRect( 0, 0, pixmapWidth, pixmapHeight ) );
+  if ( rect.size() != QSize( image->width, image->height ) )
+    memset( buffer.data(), 0, buffer.size() );
+
+  cursorRect = QRect();
+  if ( rect.isEmpty() or ( grabTile( rect ) == false ) )
+    return false;
+
+  changed = true;
+  return true;
+}
+
+
+bool QvkShmGrabber::isChanged()
+{
+  return changed;
+}
+
+
+QByteArray QvkShmGrabber::frameBuffer()
+{
+  return buffer;
+}
+
+
+/**
+ * Put back the pixels under the cursor, the frame buffer must stay free of the cursor
+ * because only damaged rectangles are grabbed again.
+ */
+void QvkShmGrabber::restoreCursor()
+{
+  if ( cursorRect.isEmpty() == true )
+    return;
+
+  int stride = bytesPerLine();
+  int length = cursorRect.width() * 4;
+  uchar *dst = (uchar *)buffer.data() + cursorRect.y() * stride + cursorRect.x() * 4;
+  const char *src = cursorUnder.constData();
+  for ( int row = 0; row < cursorRect.height(); row++ )
+    memcpy( dst + row * stride, src + row * length, length );
+
+  cursorRect = QRect();
+}
+
+
+/**
+ * XShmGetImage does not contain the mouse cursor, it is blended in with the XFixes cursor image.
+ * The pixels of the cursor image are premultiplied ARGB in unsigned long, also on 64 bit.
+ */
+void QvkShmGrabber::drawCursor()
+{
+  if ( ( image == NULL ) or ( haveXfixes == false ) or buffer.isEmpty() )
+    return;
+
+  restoreCursor();
+
+  XFixesCursorImage *cursor = XFixesGetCursorImage( display );
+  if ( cursor == NULL )
+    return;
+
+  int left = cursor->x - cursor->xhot - originX;
+  int top  = cursor->y - cursor->yhot - originY;
+  int stride = bytesPerLine();
+
+  // Save the pixels under the cursor
+  cursorRect = QRect( left, top, cursor->width, cursor->height ).intersected( QRect( 0, 0, image->width, image->height ) );
+  if ( cursorRect.isEmpty() == false )
+  {
+    int length = cursorRect.width() * 4;
+    cursorUnder.resize( length * cursorRect.height() );
+    const uchar *src = (const uchar *)buffer.constData() + cursorRect.y() * stride + cursorRect.x() * 4;
+    for ( int row = 0; row < cursorRect.height(); row++ )
+      memcpy( cursorUnder.data() + row * length, src + row * stride, length );
+  }
+
+  uchar *pixels = (uchar *)buffer.data();
+  for ( int row = 0; row < cursor->height; row++ )
+  {
+    int y = top + row;
+    if ( ( y < 0 ) or ( y >= image->height ) )
+      continue;
+
+    uchar *line = pixels + y * stride;
+    for ( int column = 0; column < cursor->width; column++ )
+    {
+      int x = left + column;
+      if ( ( x < 0 ) or ( x >= image->width ) )
+        continue;
+
+      unsigned long pixel = cursor->pixels[ row * cursor->width + column ];
+      uint alpha = ( pixel >> 24 ) & 0xff;
+      if ( alpha == 0 )
+        continue;
+
+      uchar *dst = line + x * 4;
+      dst[ 0 ] = ( ( pixel       ) & 0xff ) + dst[ 0 ] * ( 255 - alpha ) / 255;
+      dst[ 1 ] = ( ( pixel >> 8  ) & 0xff ) + dst[ 1 ] * ( 255 - alpha ) / 255;
+      dst[ 2 ] = ( ( pixel >> 16 ) & 0xff ) + dst[ 2 ] * ( 255 - alpha ) / 255;
+    }
+  }
+
+  XFree( cursor );
+}
+
+
+/**
+ * Subscribe to XDamage on the root window. Damage on a window contains all
+ * inferior windows, so every change on the screen is reported.
+ * Cursor shape changes are reported by XFixes.
+ */
+bool QvkShmGrabber::enableDamage()
+{
+  int errorBase;
+  if ( XDamageQueryExtension( display, &damageEventBase, &errorBase ) == False )
+  {
+    error = "The X server has no DAMAGE extension";
+    return false;
+  }
+
+  damage = XDamageCreate( display, ( window != 0 ) ? window : root, XDamageReportNonEmpty );
+  damagePending = true; // The first frame is always grabbed
+
+  if ( haveXfixes == true )
+    XFixesSelectCursorInput( display, root, XFixesDisplayCursorNotifyMask );
+
+  XSync( display, False );
+  return true;
+}
+
+
+void QvkShmGrabber::processEvents()
+{
+  while ( XPending( display ) > 0 )
+  {
+    XEvent event;
+    XNextEvent( display, &event );
+    if ( event.type == damageEventBase + XDamageNotify )
+      damagePending = true;
+
+    if ( ( haveXfixes == true ) and ( event.type == xfixesEventBase + XFixesCursorNotify ) )
+      cursorPending = true;
+
+    if ( window == 0 )
+      continue;
+
+    if ( ( event.type == DestroyNotify ) and ( event.xdestroywindow.window == window ) )
+    {
+      windowGone = true;
+      windowMapped = false;
+    }
+
+    if ( ( event.type == UnmapNotify ) and ( event.xunmap.window == window ) )
+      windowMapped = false;
+
+    if ( ( event.type == MapNotify ) and ( event.xmap.window == window ) )
+    {
+      windowMapped = true;
+      pixmapStale = true;
+    }
+
+    if ( ( event.type == ConfigureNotify ) and ( event.xconfigure.window == window ) and
+         ( ( event.xconfigure.width + 2 * event.xconfigure.border_width != pixmapWidth ) or
+           ( event.xconfigure.height + 2 * event.xconfigure.border_width != pixmapHeight ) ) )
+      pixmapStale = true;
+  }
+}
+
+
+/**
+ * Returns true if the rectangle width x height at x, y has changed since the last call.
+ * The damaged parts inside the rectangle are given back by damagedRects(),
+ * relative to the upper left corner of the rectangle.
+ */
+bool QvkShmGrabber::isDamaged( int x, int y )
+{
+  damageList.clear();
+  if ( damage == 0 )
+    return true;
+
+  processEvents();
+  if ( damagePending == false )
+    return false;
+  damagePending = false;
+
+  // The damage of a window is relative to the window
+  QRect capture( qBound( 0, x, qMax( 0, screenWidth() - image->width ) ),
+                 qBound( 0, y, qMax( 0, screenHeight() - image->height ) ),
+                 image->width,
+                 image->height );
+  if ( window != 0 )
+    capture = QRect( 0, 0, qMin( image->width, pixmapWidth ), qMin( image->height, pixmapHeight ) );
+
+  XserverRegion region = XFixesCreateRegion( display, NULL, 0 );
+  XDamageSubtract( display, damage, None, region );
+
+  int count = 0;
+  XRectangle *rects = XFixesFetchRegion( display, region, &count );
+  for ( int i = 0; i < count; i++ )
+  {
+    QRect rect = QRect( rects[ i ].x, rects[ i ].y, rects[ i ].width, rects[ i ].height ).intersected( capture );
+    if ( rect.isEmpty() == false )
+      damageList.append( rect.translated( -capture.x(), -capture.y() ) );
+  }
+
+  if ( rects != NULL )
+    XFree( rects );
+  XFixesDestroyRegion( display, region );
+
+  return ( damageList.isEmpty() == false );
+}
+
+
+/**
+ * Returns true if the cursor was moved inside the rectangle or has a new shape.
+ */
+bool QvkShmGrabber::isCursorChanged( int x, int y )
+{
+  processEvents();
+
+  if ( window != 0 )
+  {
+    x = originX;
+    y = originY;
+  }
+
+  Window rootReturn, childReturn;
+  int rootX, rootY, winX, winY;
+  unsigned int mask;
+  XQueryPointer( display, root, &rootReturn, &childReturn, &rootX, &rootY, &winX, &winY, &mask );
+
+  bool changed = cursorPending;
+  cursorPending = false;
+
+  if ( ( rootX != lastCursorX ) or ( rootY != lastCursorY ) )
+  {
+    QRect capture( x, y, image->width, image->height );
+    if ( capture.contains( rootX, rootY ) or capture.contains( lastCursorX, lastCursorY ) )
+      changed = true;
+    lastCursorX = rootX;
+    lastCursorY = rootY;
+  }
+
+  return changed;
+}
+
+
+/**
+ * Position of the mouse on the screen
+ */
+void QvkShmGrabber::cursorPosition( int *x, int *y )
+{
+  Window rootReturn, childReturn;
+  int winX, winY;
+  unsigned int mask;
+  XQueryPointer( display, root, &rootReturn, &childReturn, x, y, &winX, &winY, &mask );
+}
+
+
+QVector<QRect> QvkShmGrabber::damagedRects()
+{
+  return damageList;
+}
+
+
+int QvkShmGrabber::bytesPerLine()
+{
+  return image->width * 4;
+}
+
+
+int QvkShmGrabber::width()
+{
+  return image->width;
+}
+
+
+int QvkShmGrabber::height()
+{
+  return image->height;
+}
+
+
+int QvkShmGrabber::screenWidth()
+{
+  return DisplayWidth( display, DefaultScreen( display ) );
+}
+
+
+int QvkShmGrabber::screenHeight()
+{
+  return DisplayHeight( display, DefaultScreen( display ) );
+}
+
+
+QString QvkShmGrabber::errorString()
+{
+  return error;
+}
@@ -0,0 +1,107 @@
+#ifndef QvkShmGrabber_H
+#define QvkShmGrabber_H
+
+#include <QString>
+#include <QByteArray>
+#include <QRect>
+#include <QVector>
+
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/extensions/XShm.h>
+#include <X11/extensions/Xdamage.h>
+
+/*
+ * Grabs a rectangle of the root window with XShmGetImage into a
+ * shared memory segment that is allocated once and reused for every frame.
+ *
+ * The grabber opens its own connection to the X server, so it can be used
+ * from the capture thread without touching the connection of the GUI.
+ *
+ * With enableDamage() the grabber subscribes to XDamage on the root window
+ * and can tell whether something in the grabbed rectangle has changed.
+ *
+ * update() keeps a persistent frame buffer up to date. With damage only the
+ * changed rectangles are grabbed and copied into the buffer, otherwise the
+ * whole rectangle. The buffer is implicitly shared with the frames in the
+ * queue, it is only copied if the encoder still holds the last frame.
+ *
+ * With a window id the grabber records a window instead of a rectangle of
+ * the root window. The window is redirected with XComposite and grabbed from
+ * its own pixmap, so moving it, covering it with other windows or pushing it
+ * partially out of the screen changes nothing in the recording. While the
+ * window is unmapped the last picture is kept.
+ */
+class QvkShmGrabber
+{
+public:
+  QvkShmGrabber();
+  virtual ~QvkShmGrabber();
+
+  bool open( QString displayName, int width, int height, unsigned long windowId = 0 );
+  void close();
+  bool isOpen();
+
+  bool update( int x, int y );
+  bool isChanged();
+  void drawCursor();
+  QByteArray frameBuffer();
+
+  bool enableDamage();
+  bool isDamaged( int x, int y );
+  bool isCursorChanged( int x, int y );
+  void cursorPosition( int *x, int *y );
+  QVector<QRect> damagedRects();
+
+  int bytesPerLine();
+  int width();
+  int height();
+  int screenWidth();
+  int screenHeight();
+
+  QString errorString();
+
+private:
+  Display *display;
+  Window root;
+  Window window;
+  Pixmap pixmap;
+  int pixmapWidth;
+  int pixmapHeight;
+  bool pixmapStale;
+  bool windowMapped;
+  bool windowGone;
+  XImage *image;
+  XImage *tile;
+  XShmSegmentInfo shmInfo;
+  bool shmAttached;
+  bool haveXfixes;
+  int xfixesEventBase;
+  Damage damage;
+  int damageEventBase;
+  bool damagePending;
+  bool cursorPending;
+  QVector<QRect> damageList;
+  int lastCursorX;
+  int lastCursorY;
+  int originX;
+  int originY;
+  QByteArray buffer;
+  bool changed;
+  QRect cursorRect;
+  QByteArray cursorUnder;
+  QString error;
+
+  void processEvents();
+  bool grab( int x, int y );
+  bool grabTile( const QRect &rect );
+  void restoreCursor();
+
+  bool openWindow( unsigned long windowId, Visual **visual, int *depth );
+  bool namePixmap();
+  bool updateWindow();
+  bool grabWindow();
+
+};
+
+#endif
@@ -0,0 +1,29 @@
+INCLUDEPATH += $$PWD
+DEPENDPATH  += $$PWD
+HEADERS     += $$PWD/QvkFrame.h \
+               $$PWD/QvkFrameQueue.h \
+               $$PWD/QvkCaptureSettings.h \
+               $$PWD/QvkShmGrabber.h \
+               $$PWD/QvkMuxer.h \
+               $$PWD/QvkEncoder.h \
+               $$PWD/QvkCursorPan.h \
+               $$PWD/QvkDownscale.h \
+               $$PWD/QvkCaptureThread.h \
+               $$PWD/QvkEncoderThread.h \
+               $$PWD/QvkEncoderPool.h \
+               $$PWD/QvkCaptureController.h \
+               $$PWD/QvkMultiSessionRecorder.h
+
+SOURCES     += $$PWD/QvkFrameQueue.cpp \
+               $$PWD/QvkShmGrabber.cpp \
+               $$PWD/QvkMuxer.cpp \
+               $$PWD/QvkEncoder.cpp \
+               $$PWD/QvkCursorPan.cpp \
+               $$PWD/QvkDownscale.cpp \
+               $$PWD/QvkCaptureThread.cpp \
+               $$PWD/QvkEncoderThread.cpp \
+               $$PWD/QvkEncoderPool.cpp \
+               $$PWD/QvkCaptureController.cpp \
+               $$PWD/QvkMultiSessionRecorder.cpp
+
+PKGCONFIG   += x11 xext xfixes xdamage xcomposite libavcodec libavformat libavutil libswscale
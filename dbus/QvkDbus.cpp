@@ -2,14 +2,20 @@
 #include "vokoscreenqvkdbus_adaptor.h"
 #include "QvkAllLoaded.h"
 
+#include <QFile>
+
 QvkDbus::QvkDbus()
 {
+    finalizeProgress = -1;
+    jobQueue = 0;
 }
 
 
 QvkDbus::QvkDbus( Ui_screencast value )
 {
     myUi = value;
+    finalizeProgress = -1;
+    jobQueue = 0;
     
     new GuiAdaptor( this );
     QDBusConnection dbusConnection = QDBusConnection::sessionBus();
@@ -309,3 +315,68 @@ void QvkDbus::quit()
 {
     emit close();
 }
+
+
+void QvkDbus::setFinalizeProgress( int value )
+{
+    finalizeProgress = value;
+}
+
+
+/**
+ * Progress in percent of saving the last recording, -1 if nothing is saved
+ */
+QString QvkDbus::FinalizeProgress()
+{
+    return QString::number( finalizeProgress );
+}
+
+
+void QvkDbus::setJobQueue( QvkJobQueue *value )
+{
+    jobQueue = value;
+}
+
+
+/**
+ * One line per job: id state percent source destination
+ */
+QString QvkDbus::Jobs()
+{
+    if ( jobQueue == 0 )
+        return "";
+
+    return jobQueue->list().join( "\n" );
+}
+
+
+/**
+ * Compresses a video with the profile that is set in the GUI, returns the id of the job
+ */
+QString QvkDbus::JobAdd( QString value )
+{
+    if ( ( jobQueue == 0 ) or ( QFile::exists( value ) == false ) )
+        return "0";
+
+    return QString::number( jobQueue->add( myUi.RecorderLineEdit->displayText(), value, myUi.TranscodeComboBox->currentText() ) );
+}
+
+
+QString QvkDbus::JobsPause()
+{
+    if ( jobQueue == 0 )
+        return "1";
+
+    jobQueue->setPaused( true );
+    return "0";
+}
+
+
+QString QvkDbus::JobsContinue()
+{
+    if ( jobQueue == 0 )
+        return "1";
+
+    jobQueue->setPaused( false );
+    return "0";
+}
@@ -5,6 +5,8 @@
 
 #include <QObject>
 
+#include "QvkJobQueue.h"
+
 class QvkDbus: public QObject
 {
     
@@ -14,6 +16,9 @@ public:
   QvkDbus();
   QvkDbus( Ui_screencast value );
   virtual ~QvkDbus();
+
+  void setFinalizeProgress( int value );
+  void setJobQueue( QvkJobQueue *value );
   
 public slots:
   QString showAllMethods();
@@ -43,6 +48,13 @@ private slots:
 
     QString Tab(QString value );
 
+    QString FinalizeProgress();
+
+    QString Jobs();
+    QString JobAdd( QString value );
+    QString JobsPause();
+    QString JobsContinue();
+
     void quit();
 
    
@@ -54,6 +66,8 @@ protected:
   
 private:
   Ui_screencast myUi;
+  int finalizeProgress;
+  QvkJobQueue *jobQueue;
     
 };
 
@@ -0,0 +1,165 @@
+#include "QvkFileMoveThread.h"
+
+#include <QFile>
+#include <QDebug>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/stat.h>
+
+QvkFileMoveThread::QvkFileMoveThread()
+{
+  success = false;
+}
+
+
+QvkFileMoveThread::~QvkFileMoveThread()
+{
+}
+
+
+void QvkFileMoveThread::setFiles( QString source, QString destination )
+{
+  sourceFile = source;
+  destinationFile = destination;
+}
+
+
+bool QvkFileMoveThread::isSuccess()
+{
+  return success;
+}
+
+
+QString QvkFileMoveThread::errorString()
+{
+  return error;
+}
+
+
+void QvkFileMoveThread::run()
+{
+  success = false;
+  error.clear();
+
+  int in = ::open( QFile::encodeName( sourceFile ).constData(), O_RDONLY );
+  if ( in < 0 )
+  {
+    error = "Can not open " + sourceFile + ": " + strerror( errno );
+    return;
+  }
+
+  struct stat info;
+  fstat( in, &info );
+
+  int out = ::open( QFile::encodeName( destinationFile ).constData(), O_WRONLY | O_CREAT | O_TRUNC, info.st_mode & 0777 );
+  if ( out < 0 )
+  {
+    error = "Can not create " + destinationFile + ": " + strerror( errno );
+    ::close( in );
+    return;
+  }
+
+  bool ok = copy( in, out, info.st_size );
+  ::close( in );
+  if ( ::close( out ) != 0 )
+  {
+    if ( ok == true )
+      error = "Can not write " + destinationFile + ": " + strerror( errno );
+    ok = false;
+  }
+
+  // Without a complete copy the source is the only good file
+  if ( ok == false )
+  {
+    QFile::remove( destinationFile );
+    return;
+  }
+
+  QFile::remove( sourceFile );
+  success = true;
+}
+
+
+bool QvkFileMoveThread::copy( int in, int out, qint64 size )
+{
+  const size_t chunk = 8 * 1024 * 1024;
+  qint64 done = 0;
+  int lastPercent = -1;
+  bool useCopyFileRange = true;
+  QByteArray buffer;
+
+  while ( done < size )
+  {
+    ssize_t count = -1;
+    if ( useCopyFileRange == true )
+    {
+      count = copy_file_range( in, NULL, out, NULL, chunk, 0 );
+      if ( ( count < 0 ) and ( ( errno == EXDEV ) or ( errno == ENOSYS ) or ( errno == EINVAL ) ) and ( done == 0 ) )
+      {
+        // Older kernels can not copy between different filesystems
+        useCopyFileRange = false;
+        buffer.resize( chunk );
+        continue;
+      }
+
+      // Some filesystems return 0 without copying anything
+      if ( ( count == 0 ) and ( done == 0 ) )
+      {
+        useCopyFileRange = false;
+        buffer.resize( chunk );
+        continue;
+      }
+    }
+    else
+    {
+      count = ::read( in, buffer.data(), chunk );
+      if ( count > 0 )
+      {
+        ssize_t written = 0;
+        while ( written < count )
+        {
+          ssize_t ret = ::write( out, buffer.constData() + written, count - written );
+          if ( ret < 0 )
+          {
+            if ( errno == EINTR )
+              continue;
+            error = "Can not write " + destinationFile + ": " + strerror( errno );
+            return false;
+          }
+          written += ret;
+        }
+      }
+    }
+
+    if ( count < 0 )
+    {
+      if ( errno == EINTR )
+        continue;
+      error = "Can not copy " + sourceFile + ": " + strerror( errno );
+      return false;
+    }
+
+    // The file is shorter than at the beginning, checked after the loop
+    if ( count == 0 )
+      break;
+
+    done += count;
+    int percent = done * 100 / size;
+    if ( percent != lastPercent )
+    {
+      lastPercent = percent;
+      emit progress( percent, done );
+    }
+  }
+
+  if ( done != size )
+  {
+    error = "Can not copy " + sourceFile + ": only " + QString::number( done ) + " of " + QString::number( size ) + " bytes copied";
+    return false;
+  }
+
+  return true;
+}
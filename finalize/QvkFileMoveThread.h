@@ -0,0 +1,43 @@
+#ifndef QvkFileMoveThread_H
+#define QvkFileMoveThread_H
+
+#include <QThread>
+#include <QString>
+
+/*
+ * Copies a file in chunks to another filesystem and removes the source
+ * after a successful copy. copy_file_range is used, if the kernel can not
+ * copy between the filesystems read/write is used.
+ */
+class QvkFileMoveThread: public QThread
+{
+    Q_OBJECT
+
+public:
+  QvkFileMoveThread();
+  virtual ~QvkFileMoveThread();
+
+  void setFiles( QString source, QString destination );
+  bool isSuccess();
+  QString errorString();
+
+
+signals:
+  void progress( int percent, qint64 bytes );
+
+
+protected:
+  void run();
+
+
+private:
+  QString sourceFile;
+  QString destinationFile;
+  bool success;
+  QString error;
+
+  bool copy( int in, int out, qint64 size );
+
+};
+
+#endif
@@ -0,0 +1,147 @@
+#include "QvkFileMover.h"
+
+#include <QFile>
+#include <QDebug>
+
+#include <stdio.h>
+#include <errno.h>
+#include <string.h>
+
+QvkFileMover::QvkFileMover()
+{
+  percent = -1;
+  copying = false;
+  moveThread = new QvkFileMoveThread();
+  connect( moveThread, SIGNAL( progress( int, qint64 ) ), this, SLOT( threadProgress( int, qint64 ) ), Qt::QueuedConnection );
+  connect( moveThread, SIGNAL( finished() ), this, SLOT( threadFinished() ), Qt::QueuedConnection );
+}
+
+
+QvkFileMover::~QvkFileMover()
+{
+  waitForFinished();
+  delete moveThread;
+}
+
+
+bool QvkFileMover::isBusy()
+{
+  return copying or ( queue.isEmpty() == false );
+}
+
+
+/**
+ * -1 if no copy is running
+ */
+int QvkFileMover::progressPercent()
+{
+  return percent;
+}
+
+
+/**
+ * Blocks until all moves are finished, e.g. before the application is closed.
+ */
+void QvkFileMover::waitForFinished()
+{
+  while ( isBusy() )
+  {
+    if ( copying == true )
+    {
+      qDebug() << "[vokoscreen] [finalize] waiting for" << destinationFile;
+      moveThread->wait();
+      threadFinished();
+    }
+    else
+    {
+      startNext();
+    }
+  }
+}
+
+
+/**
+ * The source of the last finished(), the file is still there if the move failed
+ */
+QString QvkFileMover::getSource()
+{
+  return sourceFile;
+}
+
+
+/**
+ * Does not wait for a running copy, the move is done after the moves before it.
+ */
+void QvkFileMover::move( QString source, QString destination )
+{
+  Move value;
+  value.source = source;
+  value.destination = destination;
+  queue << value;
+
+  if ( copying == false )
+    startNext();
+}
+
+
+/**
+ * QFile::rename() is not used, it falls back to a blocking copy if the
+ * files are on different filesystems.
+ * The renames are done at once, the first copy ends the loop.
+ */
+void QvkFileMover::startNext()
+{
+  while ( ( copying == false ) and ( queue.isEmpty() == false ) )
+  {
+    Move value = queue.takeFirst();
+    sourceFile = value.source;
+    destinationFile = value.destination;
+
+    if ( ::rename( QFile::encodeName( sourceFile ).constData(), QFile::encodeName( destinationFile ).constData() ) == 0 )
+    {
+      qDebug() << "[vokoscreen] [finalize] renamed" << sourceFile << "to" << destinationFile;
+      emit finished( destinationFile, true );
+      continue;
+    }
+
+    if ( errno != EXDEV )
+    {
+      qDebug() << "[vokoscreen] [finalize] can not rename" << sourceFile << "to" << destinationFile << strerror( errno );
+      emit finished( destinationFile, false );
+      continue;
+    }
+
+    qDebug() << "[vokoscreen] [finalize] different filesystems, copy" << sourceFile << "to" << destinationFile;
+    percent = 0;
+    copying = true;
+    moveThread->setFiles( sourceFile, destinationFile );
+    moveThread->start( QThread::LowPriority );
+  }
+}
+
+
+void QvkFileMover::threadProgress( int value, qint64 bytes )
+{
+  percent = value;
+  emit progress( value, bytes );
+}
+
+
+/**
+ * Is also called by waitForFinished(), the queued signal of the thread comes later then
+ */
+void QvkFileMover::threadFinished()
+{
+  if ( ( copying == false ) or moveThread->isRunning() )
+    return;
+
+  copying = false;
+  percent = -1;
+  if ( moveThread->isSuccess() == false )
+    qDebug() << "[vokoscreen] [finalize]" << moveThread->errorString();
+  else
+    qDebug() << "[vokoscreen] [finalize] copied" << destinationFile;
+
+  emit finished( destinationFile, moveThread->isSuccess() );
+  startNext();
+}
@@ -0,0 +1,63 @@
+#ifndef QvkFileMover_H
+#define QvkFileMover_H
+
+#include <QObject>
+#include <QString>
+#include <QList>
+
+#include "QvkFileMoveThread.h"
+
+/*
+ * Moves the finished video from the temp location to the movie location.
+ * On the same filesystem this is a rename, nothing is copied.
+ * Otherwise the file is copied in a thread and finished() comes later,
+ * the GUI is not blocked. Several moves are queued and done one after
+ * the other, every move gives its own finished().
+ */
+class QvkFileMover: public QObject
+{
+    Q_OBJECT
+
+public:
+  QvkFileMover();
+  virtual ~QvkFileMover();
+
+  bool isBusy();
+  int progressPercent();
+  void waitForFinished();
+  QString getSource();
+
+
+public slots:
+  void move( QString source, QString destination );
+
+
+signals:
+  void progress( int percent, qint64 bytes );
+  void finished( QString destination, bool success );
+
+
+private slots:
+  void threadFinished();
+  void threadProgress( int value, qint64 bytes );
+
+
+private:
+  struct Move
+  {
+    QString source;
+    QString destination;
+  };
+
+  QvkFileMoveThread *moveThread;
+  QList<Move> queue;
+  QString sourceFile;
+  QString destinationFile;
+  bool copying;
+  int percent;
+
+  void startNext();
+
+};
+
+#endif
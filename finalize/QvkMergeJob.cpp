@@ -0,0 +1,221 @@
+#include "QvkMergeJob.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDebug>
+
+QvkMergeJob::QvkMergeJob()
+{
+  totalBytes = 0;
+  writtenBytes = 0;
+  percent = -1;
+
+  process = new QProcess( this );
+  connect( process, SIGNAL( readyReadStandardOutput() ), this, SLOT( readyReadStandardOutput() ) );
+  connect( process, SIGNAL( finished( int, QProcess::ExitStatus ) ), this, SLOT( processFinished( int, QProcess::ExitStatus ) ) );
+  connect( process, SIGNAL( error( QProcess::ProcessError ) ), this, SLOT( processError( QProcess::ProcessError ) ) );
+}
+
+
+QvkMergeJob::~QvkMergeJob()
+{
+  waitForFinished();
+}
+
+
+bool QvkMergeJob::isBusy()
+{
+  return ( process->state() != QProcess::NotRunning ) or ( queue.isEmpty() == false );
+}
+
+
+/**
+ * -1 if no merge is running
+ */
+int QvkMergeJob::progressPercent()
+{
+  return percent;
+}
+
+
+/**
+ * Blocks until all merges are finished, e.g. before the application is closed.
+ */
+void QvkMergeJob::waitForFinished()
+{
+  while ( isBusy() )
+  {
+    if ( process->state() != QProcess::NotRunning )
+    {
+      qDebug() << "[vokoscreen] [finalize] waiting for" << destinationFile;
+      process->waitForFinished( -1 );
+    }
+    else
+    {
+      startNext();
+    }
+  }
+}
+
+
+/**
+ * The renamed fragment directory of the last merge, the fragments stay there if it fails
+ */
+QString QvkMergeJob::getWorkDirectory()
+{
+  return workDirectory;
+}
+
+
+/**
+ * The merge that is running and the merges that wait for it
+ */
+QStringList QvkMergeJob::getBusyDirectories()
+{
+  QStringList list;
+  if ( process->state() != QProcess::NotRunning )
+    list << workDirectory;
+  for ( int i = 0; i < queue.size(); i++ )
+    list << queue[ i ].directory;
+  return list;
+}
+
+
+/**
+ * fragmentDirectory: contains only the fragments of one recording, the order is the modification time.
+ * Does not wait for a running merge, the directory is renamed at once and merged after the merges before it.
+ */
+void QvkMergeJob::start( QString program, QString fragmentDirectory, QString destination )
+{
+  Merge value;
+  value.program = program;
+  value.destination = destination;
+  value.directory = fragmentDirectory + "-merge-" + QString::number( QDateTime::currentMSecsSinceEpoch() );
+  if ( QDir().rename( fragmentDirectory, value.directory ) == false )
+  {
+    qDebug() << "[vokoscreen] [finalize] can not rename" << fragmentDirectory;
+    value.directory = fragmentDirectory;
+  }
+  queue << value;
+
+  if ( process->state() == QProcess::NotRunning )
+    startNext();
+}
+
+
+/**
+ * A slot of finished() can start the next merge already
+ */
+void QvkMergeJob::startNext()
+{
+  if ( ( process->state() != QProcess::NotRunning ) or queue.isEmpty() )
+    return;
+
+  Merge value = queue.takeFirst();
+  QString program = value.program;
+  destinationFile = value.destination;
+  workDirectory = value.directory;
+
+  QDir dir( workDirectory );
+  QStringList stringList = dir.entryList( QDir::Files, QDir::Time | QDir::Reversed );
+
+  totalBytes = 0;
+  writtenBytes = 0;
+  listFile = workDirectory + QDir::separator() + "mergeFile.txt";
+  QFile file( listFile );
+  file.open( QIODevice::WriteOnly | QIODevice::Text );
+  for ( int i = 0; i < stringList.size(); ++i )
+  {
+    QString filepath = workDirectory + QDir::separator() + stringList[ i ];
+    totalBytes += QFileInfo( filepath ).size();
+    file.write( QString( "file '" + filepath.replace( "'", "'\\''" ) + "'\n" ).toLocal8Bit() );
+  }
+  file.close();
+
+  QStringList mergeArguments;
+  mergeArguments << "-report";
+  mergeArguments << "-nostats";
+  mergeArguments << "-progress" << "pipe:1";
+  mergeArguments << "-safe" << "0";
+  mergeArguments << "-f" << "concat";
+  mergeArguments << "-i" << listFile;
+  mergeArguments << "-c" << "copy";
+  mergeArguments << destinationFile;
+
+  qDebug().noquote() << "[vokoscreen] [finalize] merge" << stringList.size() << "fragments:" << program << mergeArguments.join( " " );
+
+  percent = 0;
+  pending.clear();
+  emit progress( 0, 0 );
+  process->start( program, mergeArguments );
+}
+
+
+/**
+ * ffmpeg writes blocks of key=value lines, total_size is the size of the output file
+ */
+void QvkMergeJob::readyReadStandardOutput()
+{
+  pending.append( process->readAllStandardOutput() );
+
+  int index;
+  while ( ( index = pending.indexOf( '\n' ) ) >= 0 )
+  {
+    QByteArray line = pending.left( index ).trimmed();
+    pending.remove( 0, index + 1 );
+
+    if ( line.startsWith( "total_size=" ) )
+    {
+      writtenBytes = line.mid( 11 ).toLongLong();
+      if ( totalBytes > 0 )
+      {
+        // 100 is only reached when the process is finished
+        percent = qBound( 0, (int)( writtenBytes * 100 / totalBytes ), 99 );
+      }
+      emit progress( percent, writtenBytes );
+    }
+  }
+}
+
+
+void QvkMergeJob::processFinished( int exitCode, QProcess::ExitStatus exitStatus )
+{
+  bool success = ( exitStatus == QProcess::NormalExit ) and ( exitCode == 0 ) and ( QFileInfo( destinationFile ).size() > 0 );
+  if ( success == false )
+  {
+    qDebug().noquote() << "[vokoscreen] [finalize] merge failed with exit code" << exitCode
+                       << "- the fragments are kept in" << workDirectory;
+    QFile::remove( destinationFile );
+  }
+  else
+  {
+    QDir dir( workDirectory );
+    QStringList stringList = dir.entryList( QDir::Files );
+    for ( int i = 0; i < stringList.size(); ++i )
+      dir.remove( stringList[ i ] );
+    QDir().rmdir( workDirectory );
+    qDebug().noquote() << "[vokoscreen] [finalize] merged" << destinationFile;
+  }
+
+  percent = -1;
+  emit finished( destinationFile, success );
+  startNext();
+}
+
+
+/**
+ * If the process does not start there is no finished()
+ */
+void QvkMergeJob::processError( QProcess::ProcessError error )
+{
+  if ( error != QProcess::FailedToStart )
+    return;
+
+  qDebug().noquote() << "[vokoscreen] [finalize] can not start" << process->program()
+                     << "- the fragments are kept in" << workDirectory;
+  percent = -1;
+  emit finished( destinationFile, false );
+  startNext();
+}
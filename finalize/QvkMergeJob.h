@@ -0,0 +1,71 @@
+#ifndef QvkMergeJob_H
+#define QvkMergeJob_H
+
+#include <QObject>
+#include <QProcess>
+#include <QString>
+#include <QStringList>
+#include <QList>
+
+/*
+ * Merges the fragments of a paused recording with the ffmpeg concat demuxer
+ * in its own process, the GUI is not blocked.
+ *
+ * The fragment directory is renamed first, so a new recording can start in
+ * the temp location while the merge is running. Several merges are queued
+ * and done one after the other, every merge gives its own finished().
+ * The fragments are only removed if ffmpeg has finished without error.
+ */
+class QvkMergeJob: public QObject
+{
+    Q_OBJECT
+
+public:
+  QvkMergeJob();
+  virtual ~QvkMergeJob();
+
+  bool isBusy();
+  int progressPercent();
+  void waitForFinished();
+  QString getWorkDirectory();
+  QStringList getBusyDirectories();
+
+
+public slots:
+  void start( QString program, QString fragmentDirectory, QString destination );
+
+
+signals:
+  void progress( int percent, qint64 bytes );
+  void finished( QString destination, bool success );
+
+
+private slots:
+  void readyReadStandardOutput();
+  void processFinished( int exitCode, QProcess::ExitStatus exitStatus );
+  void processError( QProcess::ProcessError error );
+
+
+private:
+  struct Merge
+  {
+    QString program;
+    QString directory;
+    QString destination;
+  };
+
+  QProcess *process;
+  QList<Merge> queue;
+  QString workDirectory;
+  QString listFile;
+  QString destinationFile;
+  qint64 totalBytes;
+  qint64 writtenBytes;
+  int percent;
+  QByteArray pending;
+
+  void startNext();
+
+};
+
+#endif
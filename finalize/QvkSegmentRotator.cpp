@@ -0,0 +1,275 @@
+#include "QvkSegmentRotator.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDebug>
+
+static const int chunkTime = 10; // seconds
+
+QvkSegmentRotator::QvkSegmentRotator()
+{
+  listOffset = 0;
+  maxSeconds = 0;
+  maxBytes = 0;
+  active = false;
+  run = 0;
+  segmentCount = 0;
+  chunkSeconds = 0;
+  chunkBytes = 0;
+  startTime = 0;
+
+  mergeJob = new QvkMergeJob();
+  connect( mergeJob, SIGNAL( progress( int, qint64 ) ), this, SIGNAL( progress( int, qint64 ) ) );
+  connect( mergeJob, SIGNAL( finished( QString, bool ) ), this, SLOT( mergeFinished( QString, bool ) ) );
+
+  timer = new QTimer( this );
+  connect( timer, SIGNAL( timeout() ), this, SLOT( readList() ) );
+}
+
+
+QvkSegmentRotator::~QvkSegmentRotator()
+{
+  delete mergeJob;
+}
+
+
+bool QvkSegmentRotator::isActive()
+{
+  return active;
+}
+
+
+/**
+ * true as long as segments are joined or wait for it
+ */
+bool QvkSegmentRotator::isBusy()
+{
+  return mergeJob->isBusy() or ( queue.isEmpty() == false );
+}
+
+
+void QvkSegmentRotator::waitForFinished()
+{
+  while ( isBusy() )
+  {
+    if ( mergeJob->isBusy() == false )
+      startNextMerge();
+    mergeJob->waitForFinished();
+  }
+}
+
+
+/**
+ * Where the chunks of the segment of the last segmentFinished() are
+ */
+QString QvkSegmentRotator::getWorkDirectory()
+{
+  return lastDirectory;
+}
+
+
+/**
+ * The segment that is joined and the segments that wait for it
+ */
+QStringList QvkSegmentRotator::getBusyDirectories()
+{
+  QStringList list;
+  if ( mergeJob->isBusy() )
+    list << mergeJob->getWorkDirectory();
+  for ( int i = 0; i < queue.size(); i++ )
+    list << queue[ i ].directory;
+  return list;
+}
+
+
+/**
+ * seconds, bytes: limits of a segment, 0 is no limit.
+ * destination: the segments get the name with a number, e.g. vokoscreen-<date>-001.mkv
+ */
+void QvkSegmentRotator::start( QString program, QString chunkDirectory, QString format, QString destination, int seconds, qint64 bytes )
+{
+  ffmpegProgram = program;
+  directory = chunkDirectory;
+  containerFormat = format;
+  destinationBase = destination;
+  maxSeconds = seconds;
+  maxBytes = bytes;
+  run = 0;
+  segmentCount = 0;
+  chunks.clear();
+  chunkSeconds = 0;
+  chunkBytes = 0;
+  listFile.clear();
+  listOffset = 0;
+  startTime = QDateTime::currentMSecsSinceEpoch();
+  active = true;
+  timer->start( 1000 );
+
+  qDebug().noquote() << "[vokoscreen] [segment] rotate after" << seconds << "seconds or" << bytes / 1024 / 1024 << "MB";
+}
+
+
+/**
+ * Output options for ffmpeg instead of -f and the file name, each start of
+ * ffmpeg (e.g. after a pause) writes its own list and chunk names.
+ */
+QStringList QvkSegmentRotator::chunkArguments()
+{
+  // The chunks of the last run are complete now
+  readList();
+
+  run++;
+  listFile = directory + QDir::separator() + "chunks-" + QString::number( run ) + ".csv";
+  listOffset = 0;
+
+  QString suffix = QFileInfo( destinationBase ).suffix();
+  QStringList list;
+  list << "-force_key_frames" << "expr:gte(t,n_forced*" + QString::number( chunkTime ) + ")";
+  list << "-f" << "segment";
+  list << "-segment_format" << containerFormat;
+  list << "-segment_time" << QString::number( chunkTime );
+  list << "-reset_timestamps" << "1";
+  list << "-segment_list" << listFile;
+  list << "-segment_list_type" << "csv";
+  list << directory + QDir::separator() + "chunk-" + QString( "%1" ).arg( run, 3, 10, QChar( '0' ) ) + "-%05d." + suffix;
+  return list;
+}
+
+
+/**
+ * The recording is stopped, the rest becomes the last segment
+ */
+void QvkSegmentRotator::stop()
+{
+  if ( active == false )
+    return;
+
+  timer->stop();
+  readList();
+  finishSegment();
+  QFile::remove( listFile );
+  for ( int i = 1; i < run; i++ )
+    QFile::remove( directory + QDir::separator() + "chunks-" + QString::number( i ) + ".csv" );
+  active = false;
+}
+
+
+/**
+ * ffmpeg appends a line "name,start,end" when a chunk is finished
+ */
+void QvkSegmentRotator::readList()
+{
+  if ( listFile.isEmpty() )
+    return;
+
+  QFile file( listFile );
+  if ( file.open( QIODevice::ReadOnly ) == false )
+    return;
+
+  file.seek( listOffset );
+  QByteArray data = file.readAll();
+  file.close();
+
+  int index;
+  int begin = 0;
+  while ( ( index = data.indexOf( '\n', begin ) ) >= 0 )
+  {
+    QList<QByteArray> fields = data.mid( begin, index - begin ).trimmed().split( ',' );
+    begin = index + 1;
+    if ( fields.count() < 3 )
+      continue;
+
+    // Depending on the version of ffmpeg with or without path
+    QString name = QFileInfo( QFile::decodeName( fields[ 0 ] ) ).fileName();
+    double seconds = fields[ 2 ].toDouble() - fields[ 1 ].toDouble();
+    addChunk( directory + QDir::separator() + name, seconds );
+  }
+  listOffset += begin;
+}
+
+
+/**
+ * A chunk that would make the segment too big begins the next segment
+ */
+void QvkSegmentRotator::addChunk( QString fileName, double seconds )
+{
+  qint64 size = QFileInfo( fileName ).size();
+  if ( ( maxBytes > 0 ) and ( chunks.isEmpty() == false ) and ( chunkBytes + size > maxBytes ) )
+    finishSegment();
+
+  chunks << fileName;
+  chunkSeconds += seconds;
+  chunkBytes += size;
+
+  if ( ( maxSeconds > 0 ) and ( chunkSeconds >= maxSeconds - 0.5 ) )
+    finishSegment();
+}
+
+
+/**
+ * The chunks are moved into their own directory, the merge job works there
+ */
+void QvkSegmentRotator::finishSegment()
+{
+  if ( chunks.isEmpty() )
+    return;
+
+  segmentCount++;
+  QFileInfo fileInfo( destinationBase );
+
+  // Two segments can be finished in the same millisecond, the number is unique
+  QString number = QString( "%1" ).arg( segmentCount, 3, 10, QChar( '0' ) );
+  Segment segment;
+  segment.directory = directory + "-segment-" + QString::number( startTime ) + "-" + number;
+  segment.destination = fileInfo.path() + QDir::separator() + fileInfo.completeBaseName() + "-" + number + "." + fileInfo.suffix();
+
+  qDebug().noquote() << "[vokoscreen] [segment]" << segment.destination << ":" << chunks.size() << "chunks,"
+                     << qRound( chunkSeconds ) << "seconds," << chunkBytes / 1024 / 1024 << "MB";
+
+  QStringList moveChunks = chunks;
+  chunks.clear();
+  chunkSeconds = 0;
+  chunkBytes = 0;
+
+  QDir().mkpath( segment.directory );
+  qint64 movedBytes = 0;
+  for ( int i = 0; i < moveChunks.size(); ++i )
+  {
+    qint64 size = QFileInfo( moveChunks[ i ] ).size();
+    if ( QFile::rename( moveChunks[ i ], segment.directory + QDir::separator() + QFileInfo( moveChunks[ i ] ).fileName() ) == false )
+    {
+      // An incomplete list is not joined, the chunks are left for the recovery
+      qDebug().noquote() << "[vokoscreen] [segment] can not move" << moveChunks[ i ] << "to" << segment.directory;
+      emit chunksMoved( movedBytes );
+      lastDirectory = segment.directory;
+      emit segmentFinished( segment.destination, false );
+      return;
+    }
+    movedBytes += size;
+  }
+  emit chunksMoved( movedBytes );
+
+  queue << segment;
+  if ( mergeJob->isBusy() == false )
+    startNextMerge();
+}
+
+
+void QvkSegmentRotator::startNextMerge()
+{
+  if ( queue.isEmpty() )
+    return;
+
+  Segment segment = queue.takeFirst();
+  mergeJob->start( ffmpegProgram, segment.directory, segment.destination );
+}
+
+
+void QvkSegmentRotator::mergeFinished( QString destination, bool success )
+{
+  lastDirectory = mergeJob->getWorkDirectory();
+  emit segmentFinished( destination, success );
+  startNextMerge();
+}
@@ -0,0 +1,85 @@
+#ifndef QvkSegmentRotator_H
+#define QvkSegmentRotator_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+
+#include "QvkMergeJob.h"
+
+/*
+ * Splits a long recording into numbered segments by duration or size.
+ *
+ * ffmpeg writes short chunks with the segment muxer, each chunk begins
+ * with a keyframe and the finished chunks are listed in a csv file.
+ * When the chunks reach the limit they are joined with stream copy into
+ * the next segment in the movie location, in the background while the
+ * recording goes on. A crash loses only the chunks that are not joined.
+ */
+class QvkSegmentRotator: public QObject
+{
+    Q_OBJECT
+
+public:
+  QvkSegmentRotator();
+  virtual ~QvkSegmentRotator();
+
+  bool isActive();
+  bool isBusy();
+  void waitForFinished();
+  QStringList chunkArguments();
+  QString getWorkDirectory();
+  QStringList getBusyDirectories();
+
+
+public slots:
+  void start( QString program, QString chunkDirectory, QString format, QString baseName, int seconds, qint64 bytes );
+  void stop();
+
+
+signals:
+  void progress( int percent, qint64 bytes );
+  void chunksMoved( qint64 bytes );
+  void segmentFinished( QString destination, bool success );
+
+
+private slots:
+  void readList();
+  void mergeFinished( QString destination, bool success );
+
+
+private:
+  struct Segment
+  {
+    QString directory;
+    QString destination;
+  };
+
+  QvkMergeJob *mergeJob;
+  QTimer *timer;
+  QString ffmpegProgram;
+  QString directory;
+  QString containerFormat;
+  QString destinationBase;
+  QString listFile;
+  qint64 listOffset;
+  int maxSeconds;
+  qint64 maxBytes;
+  bool active;
+  int run;
+  int segmentCount;
+  QStringList chunks;
+  double chunkSeconds;
+  qint64 chunkBytes;
+  QList<Segment> queue;
+  qint64 startTime;
+  QString lastDirectory;
+
+  void addChunk( QString fileName, double seconds );
+  void finishSegment();
+  void startNextMerge();
+
+};
+
+#endif
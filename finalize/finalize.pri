@@ -0,0 +1,11 @@
+INCLUDEPATH += $$PWD
+DEPENDPATH  += $$PWD
+HEADERS     += $$PWD/QvkFileMover.h \
+               $$PWD/QvkFileMoveThread.h \
+               $$PWD/QvkMergeJob.h \
+               $$PWD/QvkSegmentRotator.h
+
+SOURCES     += $$PWD/QvkFileMover.cpp \
+               $$PWD/QvkFileMoveThread.cpp \
+               $$PWD/QvkMergeJob.cpp \
+               $$PWD/QvkSegmentRotator.cpp
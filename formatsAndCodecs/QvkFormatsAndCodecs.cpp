@@ -1,28 +1,167 @@
 #include <QProcess>
 #include <QDebug>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QCryptographicHash>
+#include <QtConcurrent/QtConcurrentRun>
 
 #include "QvkFormatsAndCodecs.h"
 
 
-QvkFormatsAndCodecs::QvkFormatsAndCodecs()
+QvkFormatsAndCodecs::QvkFormatsAndCodecs( QString progName )
 {
+  settingsName = progName;
+  watcher = new QFutureWatcher<QvkCapabilities>( this );
+  connect( watcher, SIGNAL( finished() ), this, SLOT( probeFinished() ) );
 }
 
 
 /**
  * value: is ffmpeg
+ *
+ * The tables are taken from the cache if the binary is unchanged,
+ * otherwise the recorder is asked in a thread and changed() comes later.
  */
 void QvkFormatsAndCodecs::getFormatsAndCodecs( QString value )
 {
+  QString stamp = fileStamp( value );
+  if ( ( value == recordApplikation ) and ( stamp == recordStamp ) )
+    return;
+
   recordApplikation = value;
-  
+  recordStamp = stamp;
+
+  if ( readCache( value, stamp ) == true )
+  {
+    qDebug().noquote() << "[vokoscreen] [formats] capabilities of" << value << "from cache";
+    emit changed();
+    return;
+  }
+
+  // A running probe is restarted with the new recorder when it is finished
+  if ( watcher->isRunning() == false )
+    watcher->setFuture( QtConcurrent::run( &QvkFormatsAndCodecs::probe, value, stamp ) );
+}
+
+
+QString QvkFormatsAndCodecs::getVersion()
+{
+  return version;
+}
+
+
+bool QvkFormatsAndCodecs::isProbing()
+{
+  return watcher->isRunning();
+}
+
+
+void QvkFormatsAndCodecs::probeFinished()
+{
+  QvkCapabilities result = watcher->result();
+  if ( ( result.recorder != recordApplikation ) or ( result.stamp != recordStamp ) )
+  {
+    watcher->setFuture( QtConcurrent::run( &QvkFormatsAndCodecs::probe, recordApplikation, recordStamp ) );
+    return;
+  }
+
+  qDebug().noquote() << "[vokoscreen] [formats] capabilities of" << result.recorder << "probed";
+  setCapabilities( result );
+  writeCache();
+  emit changed();
+}
+
+
+/**
+ * Size and modification time, a new ffmpeg at the same path gives a new stamp.
+ * Empty if the binary does not exist.
+ */
+QString QvkFormatsAndCodecs::fileStamp( QString recorder )
+{
+  QString path = recorder;
+  if ( path.contains( "/" ) == false )
+    path = QStandardPaths::findExecutable( recorder );
+
+  QFileInfo fileInfo( path );
+  if ( ( path.isEmpty() == true ) or ( fileInfo.exists() == false ) )
+    return "";
+
+  return QString::number( fileInfo.size() ) + ":" + QString::number( fileInfo.lastModified().toMSecsSinceEpoch() );
+}
+
+
+bool QvkFormatsAndCodecs::readCache( QString recorder, QString stamp )
+{
+  if ( stamp.isEmpty() == true )
+    return false;
+
+  QSettings settings( settingsName, "capabilities" );
+  settings.beginGroup( QCryptographicHash::hash( recorder.toUtf8(), QCryptographicHash::Md5 ).toHex() );
+  if ( ( settings.value( "Recorder" ).toString() != recorder ) or ( settings.value( "Stamp" ).toString() != stamp ) )
+    return false;
+
+  QvkCapabilities value;
+  value.recorder = recorder;
+  value.stamp = stamp;
+  value.version = settings.value( "Version" ).toString();
+  value.codecs = settings.value( "Codecs" ).toStringList();
+  value.formats = settings.value( "Formats" ).toStringList();
+  value.devices = settings.value( "Devices" ).toStringList();
+  setCapabilities( value );
+  return true;
+}
+
+
+void QvkFormatsAndCodecs::writeCache()
+{
+  if ( recordStamp.isEmpty() == true )
+    return;
+
+  QSettings settings( settingsName, "capabilities" );
+  settings.beginGroup( QCryptographicHash::hash( recordApplikation.toUtf8(), QCryptographicHash::Md5 ).toHex() );
+    settings.setValue( "Recorder", recordApplikation );
+    settings.setValue( "Stamp", recordStamp );
+    settings.setValue( "Version", version );
+    settings.setValue( "Codecs", ListCodecs );
+    settings.setValue( "Formats", ListFormats );
+    settings.setValue( "Devices", ListDevices );
+  settings.endGroup();
+}
+
+
+void QvkFormatsAndCodecs::setCapabilities( QvkCapabilities value )
+{
+  version = value.version;
+  ListCodecs = value.codecs;
+  ListFormats = value.formats;
+  ListDevices = value.devices;
+}
+
+
+QString QvkFormatsAndCodecs::readOutput( QString recorder, QString argument )
+{
   QProcess SystemCall;
-    SystemCall.start( recordApplikation + " " + "-encoders" );
+    SystemCall.start( recorder, QStringList( argument ) );
     SystemCall.waitForFinished();
-    QString codecs = SystemCall.readAllStandardOutput();
+    QString output = SystemCall.readAllStandardOutput();
   SystemCall.close();
-  
-  ListCodecs = codecs.split( "\n" );
+  return output;
+}
+
+
+/**
+ * Runs in a thread of the global pool
+ */
+QvkCapabilities QvkFormatsAndCodecs::probe( QString recorder, QString stamp )
+{
+  QvkCapabilities value;
+  value.recorder = recorder;
+  value.stamp = stamp;
+  value.version = readOutput( recorder, "-version" ).section( "\n", 0, 0 );
+
+  QStringList ListCodecs = readOutput( recorder, "-encoders" ).split( "\n" );
   
   // delete Header inclusive " ------"
   int index = ListCodecs.indexOf( " ------" );
@@ -35,14 +174,10 @@ void QvkFormatsAndCodecs::getFormatsAndCodecs( QString value )
     ListCodecs[ i ] = ListCodecs[ i ].simplified();
     ListCodecs[ i ] = ListCodecs[ i ].section( " ", 0, 1 );
   }
+  value.codecs = ListCodecs;
 
   //**************************************
-  SystemCall.start( recordApplikation + " " + "-formats" );
-  SystemCall.waitForFinished();
-  QString formats = SystemCall.readAllStandardOutput();
-  SystemCall.close();
-  
-  ListFormats = formats.split( "\n" );
+  QStringList ListFormats = readOutput( recorder, "-formats" ).split( "\n" );
   
   // delete Header inclusive " --"
   index = ListFormats.indexOf( " --" );
@@ -60,14 +195,10 @@ void QvkFormatsAndCodecs::getFormatsAndCodecs( QString value )
     
     ListFormats[ i ] = ListFormats[ i ].section( " ", 0, 1 );
   }
+  value.formats = ListFormats;
   
   //*************************************
-  SystemCall.start( recordApplikation + " " + "-devices" );
-  SystemCall.waitForFinished();
-  QString devices = SystemCall.readAllStandardOutput();
-  SystemCall.close();
-  
-  ListDevices  = devices.split( "\n" );
+  QStringList ListDevices = readOutput( recorder, "-devices" ).split( "\n" );
   
   // delete Header inclusive " --"
   index = ListDevices.indexOf( " --" );
@@ -79,6 +210,9 @@ void QvkFormatsAndCodecs::getFormatsAndCodecs( QString value )
     ListDevices[ i ] = ListDevices[ i ].simplified();
     ListDevices[ i ] = ListDevices[ i ].section( " ", 1, 1 );
   }
+  value.devices = ListDevices;
+
+  return value;
 }
 
 
@@ -1,22 +1,39 @@
-
 #ifndef QvkFormatsAndCodecs_H
 #define QvkFormatsAndCodecs_H
 
 #include <QApplication>
 #include <QMainWindow> 
 #include <QLabel>
+#include <QFutureWatcher>
+
+/*
+ * What the recorder can, parsed from "-version", "-encoders", "-formats" and "-devices".
+ */
+struct QvkCapabilities
+{
+  QString recorder;
+  QString stamp;
+  QString version;
+  QStringList codecs;
+  QStringList formats;
+  QStringList devices;
+};
+
 
 class QvkFormatsAndCodecs: public QObject
 {
     Q_OBJECT
     
 public:
-    QvkFormatsAndCodecs();
+    QvkFormatsAndCodecs( QString progName );
     void getFormatsAndCodecs( QString recordApplikation );
+    QString getVersion();
+    bool isProbing();
     virtual ~QvkFormatsAndCodecs();
   
     
 signals:
+  void changed();
 
  
 public slots:
@@ -26,13 +43,25 @@ public slots:
 
 
 private slots:
+  void probeFinished();
 
   
 private:
+  static QvkCapabilities probe( QString recorder, QString stamp );
+  static QString readOutput( QString recorder, QString argument );
+  static QString fileStamp( QString recorder );
+  bool readCache( QString recorder, QString stamp );
+  void writeCache();
+  void setCapabilities( QvkCapabilities value );
+
+  QString settingsName;
   QString recordApplikation;
+  QString recordStamp;
+  QString version;
   QStringList ListCodecs;
   QStringList ListFormats;
   QStringList ListDevices;
+  QFutureWatcher<QvkCapabilities> *watcher;
   
 protected:  
 
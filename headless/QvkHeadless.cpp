@@ -0,0 +1,308 @@
+#include "QvkHeadless.h"
+#include "QvkThreadPolicy.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QFileInfo>
+#include <QRegExp>
+#include <QTimer>
+#include <QDebug>
+
+#include <iostream>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include <X11/Xlib.h>
+
+int QvkHeadless::signalFd[ 2 ];
+
+QvkHeadless::QvkHeadless()
+{
+  exitCode = Success;
+  notifier = NULL;
+  recorder = NULL;
+}
+
+
+QvkHeadless::~QvkHeadless()
+{
+  delete recorder;
+}
+
+
+/**
+ * Checked before any QApplication is created, the headless mode needs none
+ */
+bool QvkHeadless::isHeadless( int argc, char **argv )
+{
+  for ( int i = 1; i < argc; i++ )
+    if ( QString( argv[ i ] ) == "--headless" )
+      return true;
+  return false;
+}
+
+
+/**
+ * A signal handler may only write to a pipe, the rest is done in the event loop
+ */
+void QvkHeadless::signalHandler( int value )
+{
+  char c = (char)value;
+  ssize_t ret = ::write( signalFd[ 0 ], &c, sizeof( c ) );
+  (void)ret;
+}
+
+
+int QvkHeadless::exec()
+{
+  QCommandLineParser parser;
+  parser.setApplicationDescription( "vokoscreen headless recording" );
+  parser.addHelpOption();
+  parser.addOption( QCommandLineOption( "headless", "Record without GUI." ) );
+  parser.addOption( QCommandLineOption( "display", "X display, default $DISPLAY. Can be given more than once.", "name", qgetenv( "DISPLAY" ) ) );
+  parser.addOption( QCommandLineOption( "area", "Recorded rectangle x,y,width,height or WxH+X+Y, default the whole screen.", "area" ) );
+  parser.addOption( QCommandLineOption( "fps", "Frames per second, default 25.", "fps", "25" ) );
+  parser.addOption( QCommandLineOption( "codec", "Video codec, default libx264, libvpx for webm.", "codec" ) );
+  parser.addOption( QCommandLineOption( "out", "Output file, the container is taken from the extension: mkv, webm, mp4, mov. "
+                                               "One per display, or one for all, the display number is then added to the name.", "file" ) );
+  parser.addOption( QCommandLineOption( "encoders", "Encoder threads shared by all displays, default the cores minus one.", "threads" ) );
+  parser.addOption( QCommandLineOption( "duration", "Seconds to record, default until SIGINT or SIGTERM.", "seconds", "0" ) );
+  parser.addOption( QCommandLineOption( "no-cursor", "Do not record the mouse cursor." ) );
+  parser.addOption( QCommandLineOption( "vfr", "Variable frame rate, only changed frames are recorded." ) );
+
+  if ( parser.parse( QCoreApplication::arguments() ) == false )
+  {
+    std::cerr << parser.errorText().toStdString() << std::endl;
+    return UsageError;
+  }
+
+  if ( parser.isSet( "help" ) )
+  {
+    std::cout << parser.helpText().toStdString();
+    return Success;
+  }
+
+  displays = parser.values( "display" );
+  QStringList fileNames = parser.values( "out" );
+  if ( fileNames.isEmpty() or ( ( fileNames.count() > 1 ) and ( fileNames.count() != displays.count() ) ) )
+  {
+    std::cerr << "--out must be given once or once per display" << std::endl;
+    return UsageError;
+  }
+
+  QRect area;
+  if ( parser.isSet( "area" ) and ( parseArea( parser.value( "area" ), &area ) == false ) )
+  {
+    std::cerr << "--area must be x,y,width,height or WxH+X+Y" << std::endl;
+    return UsageError;
+  }
+
+  bool ok;
+  int fps = parser.value( "fps" ).toInt( &ok );
+  if ( ( ok == false ) or ( fps < 1 ) or ( fps > 200 ) )
+  {
+    std::cerr << "--fps must be between 1 and 200" << std::endl;
+    return UsageError;
+  }
+
+  int duration = parser.value( "duration" ).toInt( &ok );
+  if ( ( ok == false ) or ( duration < 0 ) )
+  {
+    std::cerr << "--duration must be a number of seconds" << std::endl;
+    return UsageError;
+  }
+
+  // One display gets the threads of the codec, many displays share the pool with one thread per encoder
+  QvkThreadPolicy threadPolicy;
+  int encoders = qMin( displays.count(), qMax( 1, QvkThreadPolicy::cores() - 1 ) );
+  if ( parser.isSet( "encoders" ) )
+  {
+    encoders = parser.value( "encoders" ).toInt( &ok );
+    if ( ( ok == false ) or ( encoders < 1 ) )
+    {
+      std::cerr << "--encoders must be at least 1" << std::endl;
+      return UsageError;
+    }
+  }
+
+  QList<QvkCaptureSettings> list;
+  for ( int i = 0; i < displays.count(); i++ )
+  {
+    QString display = displays.at( i );
+    QString fileName = ( fileNames.count() == 1 ) ? sessionFileName( fileNames.at( 0 ), display ) : fileNames.at( i );
+    QString format = formatOf( fileName );
+    if ( format.isEmpty() )
+    {
+      std::cerr << "--out must be a file with the extension mkv, webm, mp4 or mov" << std::endl;
+      return UsageError;
+    }
+
+    QRect rect;
+    if ( screenSize( display, &rect ) == false )
+    {
+      std::cerr << "Can not open display " << display.toStdString() << std::endl;
+      return StartFailed;
+    }
+
+    if ( parser.isSet( "area" ) )
+      rect = area.intersected( rect );
+
+    QString codec = parser.value( "codec" );
+    if ( codec.isEmpty() )
+      codec = ( format == "webm" ) ? "libvpx" : "libx264";
+
+    QvkCaptureSettings settings;
+    settings.display = display;
+    settings.x = rect.x();
+    settings.y = rect.y();
+    settings.width = rect.width() / 2 * 2;
+    settings.height = rect.height() / 2 * 2;
+    settings.frameRate = fps;
+    settings.showCursor = not parser.isSet( "no-cursor" );
+    settings.variableFrameRate = parser.isSet( "vfr" );
+    settings.fileName = fileName;
+    settings.format = format;
+    settings.videoCodec = codec;
+    if ( codec.startsWith( "libx26" ) )
+      settings.codecOptions << "-preset" << "veryfast";
+    if ( displays.count() == 1 )
+    {
+      settings.codecOptions << threadPolicy.codecOptions( codec );
+      settings.threads = threadPolicy.threads( codec );
+    }
+    else
+    {
+      settings.codecOptions << "-threads" << "1";
+      settings.threads = 1;
+    }
+    list << settings;
+
+    qDebug().noquote() << "[vokoscreen] [headless] record" << display << settings.width << "x" << settings.height
+                       << "+" << settings.x << "+" << settings.y << fps << "fps" << codec << "to" << fileName;
+  }
+
+  // SIGINT and SIGTERM end the recording regular, the file gets its trailer
+  if ( socketpair( AF_UNIX, SOCK_STREAM, 0, signalFd ) == 0 )
+  {
+    notifier = new QSocketNotifier( signalFd[ 1 ], QSocketNotifier::Read, this );
+    connect( notifier, SIGNAL( activated( int ) ), this, SLOT( signalReceived() ) );
+    struct sigaction action;
+    action.sa_handler = QvkHeadless::signalHandler;
+    sigemptyset( &action.sa_mask );
+    action.sa_flags = SA_RESTART;
+    sigaction( SIGINT, &action, NULL );
+    sigaction( SIGTERM, &action, NULL );
+  }
+
+  recorder = new QvkMultiSessionRecorder( encoders );
+  connect( recorder, SIGNAL( stopped() ), this, SLOT( captureStopped() ) );
+  connect( recorder, SIGNAL( metrics( int, QvkEncoderMetrics ) ), this, SLOT( captureMetrics( int, QvkEncoderMetrics ) ) );
+
+  if ( recorder->start( list ) == false )
+  {
+    std::cerr << recorder->errorString().toStdString() << std::endl;
+    return StartFailed;
+  }
+
+  if ( duration > 0 )
+    QTimer::singleShot( duration * 1000, recorder, SLOT( stop() ) );
+
+  return QCoreApplication::exec();
+}
+
+
+void QvkHeadless::signalReceived()
+{
+  char c;
+  ssize_t ret = ::read( signalFd[ 1 ], &c, sizeof( c ) );
+  (void)ret;
+
+  qDebug().noquote() << "[vokoscreen] [headless] signal" << (int)c << "- stop recording";
+  recorder->stop();
+}
+
+
+/**
+ * All displays have stopped after the end or after an error
+ */
+void QvkHeadless::captureStopped()
+{
+  if ( recorder->errorString().isEmpty() == false )
+  {
+    std::cerr << recorder->errorString().toStdString() << std::endl;
+    exitCode = RecordingFailed;
+  }
+
+  QCoreApplication::exit( exitCode );
+}
+
+
+void QvkHeadless::captureMetrics( int session, QvkEncoderMetrics value )
+{
+  qDebug().noquote() << "[vokoscreen] [headless]" << displays.value( session ) << "frame" << value.frame << "fps" << qRound( value.fps )
+                     << "speed" << QString::number( value.speed, 'f', 2 ) + "x"
+                     << "size" << value.totalSize / 1024 << "KB" << "dropped" << value.dropFrames;
+}
+
+
+bool QvkHeadless::screenSize( QString display, QRect *rect )
+{
+  Display *xDisplay = XOpenDisplay( display.toLocal8Bit().constData() );
+  if ( xDisplay == NULL )
+    return false;
+
+  int screen = DefaultScreen( xDisplay );
+  *rect = QRect( 0, 0, DisplayWidth( xDisplay, screen ), DisplayHeight( xDisplay, screen ) );
+  XCloseDisplay( xDisplay );
+  return true;
+}
+
+
+bool QvkHeadless::parseArea( QString value, QRect *rect )
+{
+  QRegExp list( "^(\\d+),(\\d+),(\\d+),(\\d+)$" );
+  if ( list.indexIn( value ) >= 0 )
+  {
+    *rect = QRect( list.cap( 1 ).toInt(), list.cap( 2 ).toInt(), list.cap( 3 ).toInt(), list.cap( 4 ).toInt() );
+    return ( rect->width() >= 2 ) and ( rect->height() >= 2 );
+  }
+
+  QRegExp geometry( "^(\\d+)x(\\d+)\\+(\\d+)\\+(\\d+)$" );
+  if ( geometry.indexIn( value ) >= 0 )
+  {
+    *rect = QRect( geometry.cap( 3 ).toInt(), geometry.cap( 4 ).toInt(), geometry.cap( 1 ).toInt(), geometry.cap( 2 ).toInt() );
+    return ( rect->width() >= 2 ) and ( rect->height() >= 2 );
+  }
+
+  return false;
+}
+
+
+/**
+ * Empty if the extension is not known
+ */
+QString QvkHeadless::formatOf( QString fileName )
+{
+  QString suffix = QFileInfo( fileName ).suffix().toLower();
+  if ( suffix == "mkv" )
+    return "matroska";
+  if ( ( suffix == "webm" ) or ( suffix == "mp4" ) or ( suffix == "mov" ) )
+    return suffix;
+  return "";
+}
+
+
+/**
+ * test.mkv on display :99 becomes test-99.mkv, with only one display the name is kept
+ */
+QString QvkHeadless::sessionFileName( QString fileName, QString display )
+{
+  if ( displays.count() == 1 )
+    return fileName;
+
+  QString number = display.mid( display.lastIndexOf( ':' ) + 1 ).replace( '.', '-' );
+  QFileInfo info( fileName );
+  QString base = fileName.left( fileName.length() - info.suffix().length() - 1 );
+  return base + "-" + number + "." + info.suffix();
+}
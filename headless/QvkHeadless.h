@@ -0,0 +1,60 @@
+#ifndef QvkHeadless_H
+#define QvkHeadless_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QRect>
+#include <QSocketNotifier>
+
+#include "QvkMultiSessionRecorder.h"
+
+/*
+ * Records without widgets and without DBus, e.g. on a test machine with Xvfb:
+ *
+ * vokoscreen --headless --display :99 --area 0,0,1280,720 --out test.mkv --duration 60
+ *
+ * --display and --out can be given more than once, all displays are then
+ * recorded at the same time and share one pool of encoder threads.
+ *
+ * The native capture engine runs on a QCoreApplication. The recording ends
+ * after --duration or with SIGINT or SIGTERM, the file is finalized in both
+ * cases. The exit code tells a script what has happened.
+ */
+class QvkHeadless: public QObject
+{
+    Q_OBJECT
+
+public:
+  enum ExitCode { Success = 0, UsageError = 1, StartFailed = 2, RecordingFailed = 3 };
+
+  QvkHeadless();
+  virtual ~QvkHeadless();
+
+  static bool isHeadless( int argc, char **argv );
+  int exec();
+
+
+private slots:
+  void signalReceived();
+  void captureStopped();
+  void captureMetrics( int session, QvkEncoderMetrics value );
+
+
+private:
+  QvkMultiSessionRecorder *recorder;
+  QStringList displays;
+  QSocketNotifier *notifier;
+  int exitCode;
+
+  static int signalFd[ 2 ];
+  static void signalHandler( int value );
+
+  bool screenSize( QString display, QRect *rect );
+  bool parseArea( QString value, QRect *rect );
+  QString formatOf( QString fileName );
+  QString sessionFileName( QString fileName, QString display );
+
+};
+
+#endif
@@ -0,0 +1,5 @@
+INCLUDEPATH += $$PWD
+DEPENDPATH  += $$PWD
+HEADERS     += $$PWD/QvkHeadless.h
+
+SOURCES     += $$PWD/QvkHeadless.cpp
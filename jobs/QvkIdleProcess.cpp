@@ -0,0 +1,40 @@
+#include "QvkIdleProcess.h"
+
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+// From linux/ioprio.h, not every distribution installs it
+static const int ioprioWhoProcess = 1;
+static const int ioprioClassIdle = 3;
+static const int ioprioClassShift = 13;
+
+QvkIdleProcess::QvkIdleProcess( QObject *parent ) : QProcess( parent )
+{
+}
+
+
+QvkIdleProcess::~QvkIdleProcess()
+{
+}
+
+
+/**
+ * Runs in the child after fork(), only async signal safe calls are allowed here.
+ * If the kernel refuses, the program runs with the normal priority.
+ */
+void QvkIdleProcess::setupChildProcess()
+{
+#ifdef SCHED_IDLE
+  struct sched_param param;
+  param.sched_priority = 0;
+  sched_setscheduler( 0, SCHED_IDLE, &param );
+#else
+  int ret = nice( 19 );
+  (void)ret;
+#endif
+
+#ifdef SYS_ioprio_set
+  syscall( SYS_ioprio_set, ioprioWhoProcess, 0, ioprioClassIdle << ioprioClassShift );
+#endif
+}
@@ -0,0 +1,25 @@
+#ifndef QvkIdleProcess_H
+#define QvkIdleProcess_H
+
+#include <QProcess>
+
+/*
+ * A process that gets only the cpu and the disk that nobody else needs.
+ * The child is set to SCHED_IDLE and to the idle io class before the
+ * program is started.
+ */
+class QvkIdleProcess: public QProcess
+{
+    Q_OBJECT
+
+public:
+  QvkIdleProcess( QObject *parent = 0 );
+  virtual ~QvkIdleProcess();
+
+
+protected:
+  void setupChildProcess();
+
+};
+
+#endif
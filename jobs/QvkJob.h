@@ -0,0 +1,24 @@
+#ifndef QvkJob_H
+#define QvkJob_H
+
+#include <QString>
+#include <QStringList>
+
+/*
+ * A transcode of a finished recording.
+ * arguments are the ffmpeg options between input and output, e.g. "-c:v" "libx264" "-crf" "20".
+ */
+struct QvkJob
+{
+  enum State { Waiting = 0, Running = 1, Paused = 2, Done = 3, Failed = 4 };
+
+  int id = 0;
+  QString program;
+  QString source;
+  QString destination;
+  QStringList arguments;
+  int state = Waiting;
+  int percent = 0;
+};
+
+#endif
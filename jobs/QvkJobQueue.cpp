@@ -0,0 +1,527 @@
+#include "QvkJobQueue.h"
+#include "QvkThreadPolicy.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QSaveFile>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QRegExp>
+#include <QDebug>
+
+#include <signal.h>
+
+QvkJobQueue::QvkJobQueue( QString fileName )
+{
+  jobFile = fileName;
+  nextId = 1;
+  paused = false;
+  userPaused = false;
+  recording = false;
+  load();
+
+  // Every worker gets some cores, a few big encoders are faster than many small ones
+  int count = qMax( 1, QvkThreadPolicy::cores() / 4 );
+  for ( int i = 0; i < count; i++ )
+  {
+    Worker worker;
+    worker.process = new QvkIdleProcess( this );
+    worker.parser = new QvkProgressParser();
+    worker.parser->setParent( this );
+    worker.job = 0;
+    worker.duration = 0;
+    connect( worker.process, SIGNAL( readyReadStandardOutput() ), this, SLOT( readyReadStandardOutput() ) );
+    connect( worker.process, SIGNAL( readyReadStandardError() ), this, SLOT( readyReadStandardError() ) );
+    connect( worker.process, SIGNAL( finished( int, QProcess::ExitStatus ) ), this, SLOT( processFinished( int, QProcess::ExitStatus ) ) );
+    connect( worker.process, SIGNAL( error( QProcess::ProcessError ) ), this, SLOT( processError( QProcess::ProcessError ) ) );
+    connect( worker.process, SIGNAL( started() ), this, SLOT( processStarted() ) );
+    connect( worker.parser, SIGNAL( metrics( QvkEncoderMetrics ) ), this, SLOT( parserMetrics( QvkEncoderMetrics ) ) );
+    workers << worker;
+  }
+
+  qDebug().noquote() << "[vokoscreen] [jobs]" << jobs.count() << "jobs," << count << "workers";
+  startNext();
+}
+
+
+QvkJobQueue::~QvkJobQueue()
+{
+  stop();
+}
+
+
+QStringList QvkJobQueue::profiles()
+{
+  return QStringList() << "x264" << "x265" << "vp9";
+}
+
+
+/**
+ * The audio is copied, matroska takes every audio codec that vokoscreen records
+ */
+QStringList QvkJobQueue::profileArguments( QString profile )
+{
+  QStringList list;
+  if ( profile == "x264" )
+    list << "-c:v" << "libx264" << "-preset" << "slow" << "-crf" << "20";
+
+  if ( profile == "x265" )
+    list << "-c:v" << "libx265" << "-preset" << "medium" << "-crf" << "24";
+
+  if ( profile == "vp9" )
+    list << "-c:v" << "libvpx-vp9" << "-b:v" << "0" << "-crf" << "32" << "-row-mt" << "1";
+
+  list << "-pix_fmt" << "yuv420p" << "-c:a" << "copy";
+  return list;
+}
+
+
+int QvkJobQueue::count()
+{
+  return jobs.count();
+}
+
+
+QvkJob QvkJobQueue::job( int index )
+{
+  return jobs.value( index );
+}
+
+
+int QvkJobQueue::workerCount()
+{
+  return workers.count();
+}
+
+
+bool QvkJobQueue::isPaused()
+{
+  return paused;
+}
+
+
+/**
+ * One line for the statusbar
+ */
+QString QvkJobQueue::summary()
+{
+  int count[ 5 ] = { 0, 0, 0, 0, 0 };
+  QStringList running;
+  for ( int i = 0; i < jobs.count(); i++ )
+  {
+    count[ qBound( 0, jobs[ i ].state, 4 ) ]++;
+    if ( jobs[ i ].state == QvkJob::Running )
+      running << QString::number( jobs[ i ].percent ) + " %";
+  }
+
+  QStringList list;
+  if ( count[ QvkJob::Running ] > 0 )
+    list << tr( "running" ) + " " + running.join( ", " );
+  if ( count[ QvkJob::Paused ] > 0 )
+    list << QString::number( count[ QvkJob::Paused ] ) + " " + tr( "paused" );
+  if ( count[ QvkJob::Waiting ] > 0 )
+    list << QString::number( count[ QvkJob::Waiting ] ) + " " + tr( "waiting" );
+  if ( count[ QvkJob::Done ] > 0 )
+    list << QString::number( count[ QvkJob::Done ] ) + " " + tr( "done" );
+  if ( count[ QvkJob::Failed ] > 0 )
+    list << QString::number( count[ QvkJob::Failed ] ) + " " + tr( "failed" );
+
+  if ( list.isEmpty() )
+    return tr( "No jobs" );
+  return list.join( ", " );
+}
+
+
+/**
+ * One line per job: id state percent source destination
+ */
+QStringList QvkJobQueue::list()
+{
+  QStringList states;
+  states << "waiting" << "running" << "paused" << "done" << "failed";
+
+  QStringList result;
+  for ( int i = 0; i < jobs.count(); i++ )
+    result << QString::number( jobs[ i ].id ) + " " + states.value( jobs[ i ].state ) + " "
+              + QString::number( jobs[ i ].percent ) + "% " + jobs[ i ].source + " " + jobs[ i ].destination;
+  return result;
+}
+
+
+/**
+ * The result is written beside the source, e.g. vokoscreen-<date>-x264.mkv
+ */
+int QvkJobQueue::add( QString program, QString source, QString profile )
+{
+  QFileInfo fileInfo( source );
+
+  QvkJob job;
+  job.id = nextId++;
+  job.program = program;
+  job.source = source;
+  job.destination = fileInfo.path() + QDir::separator() + fileInfo.completeBaseName() + "-" + profile + ".mkv";
+  job.arguments = profileArguments( profile );
+  jobs << job;
+
+  qDebug().noquote() << "[vokoscreen] [jobs] add" << job.id << source << "->" << job.destination;
+  save();
+  emit changed();
+  startNext();
+  return job.id;
+}
+
+
+/**
+ * The pause of the user
+ */
+void QvkJobQueue::setPaused( bool value )
+{
+  userPaused = value;
+  updatePaused();
+}
+
+
+/**
+ * The workers are held while a recording is running
+ */
+void QvkJobQueue::setRecording( bool value )
+{
+  recording = value;
+  updatePaused();
+}
+
+
+/**
+ * SIGSTOP keeps the process with all its memory, SIGCONT lets it go on where it was
+ */
+void QvkJobQueue::updatePaused()
+{
+  bool value = userPaused or recording;
+  if ( paused == value )
+    return;
+
+  paused = value;
+  for ( int i = 0; i < workers.count(); i++ )
+  {
+    int index = indexOf( workers[ i ].job );
+    if ( index < 0 )
+      continue;
+
+    signalWorker( i );
+    jobs[ index ].state = paused ? QvkJob::Paused : QvkJob::Running;
+  }
+
+  qDebug().noquote() << "[vokoscreen] [jobs]" << ( paused ? "paused" : "resumed" );
+  emit changed();
+  if ( paused == false )
+    startNext();
+}
+
+
+/**
+ * A process that is not started yet or has ended has no pid,
+ * kill() with 0 would stop the whole process group with vokoscreen.
+ */
+void QvkJobQueue::signalWorker( int worker )
+{
+  qint64 pid = workers[ worker ].process->processId();
+  if ( pid <= 0 )
+    return;
+
+  kill( (pid_t)pid, paused ? SIGSTOP : SIGCONT );
+}
+
+
+/**
+ * A worker that was starting during the pause is stopped now
+ */
+void QvkJobQueue::processStarted()
+{
+  int worker = workerOf( sender() );
+  if ( ( worker < 0 ) or ( paused == false ) )
+    return;
+
+  signalWorker( worker );
+}
+
+
+void QvkJobQueue::removeFinished()
+{
+  for ( int i = jobs.count() - 1; i >= 0; i-- )
+    if ( ( jobs[ i ].state == QvkJob::Done ) or ( jobs[ i ].state == QvkJob::Failed ) )
+      jobs.removeAt( i );
+
+  save();
+  emit changed();
+}
+
+
+/**
+ * When vokoscreen ends, the running jobs begin again with the next start
+ */
+void QvkJobQueue::stop()
+{
+  for ( int i = 0; i < workers.count(); i++ )
+  {
+    int index = indexOf( workers[ i ].job );
+    if ( index < 0 )
+      continue;
+
+    workers[ i ].process->blockSignals( true );
+    workers[ i ].process->kill();
+    workers[ i ].process->waitForFinished( 1000 );
+    workers[ i ].process->blockSignals( false );
+    workers[ i ].job = 0;
+    QFile::remove( jobs[ index ].destination );
+    jobs[ index ].state = QvkJob::Waiting;
+    jobs[ index ].percent = 0;
+  }
+  save();
+}
+
+
+void QvkJobQueue::startNext()
+{
+  if ( paused == true )
+    return;
+
+  int threads = qMax( 1, QvkThreadPolicy::cores() / workers.count() );
+  for ( int i = 0; i < workers.count(); i++ )
+  {
+    if ( workers[ i ].job != 0 )
+      continue;
+
+    int index = -1;
+    for ( int j = 0; j < jobs.count(); j++ )
+    {
+      if ( jobs[ j ].state == QvkJob::Waiting )
+      {
+        index = j;
+        break;
+      }
+    }
+    if ( index < 0 )
+      break;
+
+    QStringList arguments;
+    arguments << "-y" << "-nostats" << "-progress" << "pipe:1";
+    arguments << "-i" << jobs[ index ].source;
+    arguments << jobs[ index ].arguments;
+    arguments << "-threads" << QString::number( threads );
+    arguments << jobs[ index ].destination;
+
+    jobs[ index ].state = QvkJob::Running;
+    jobs[ index ].percent = 0;
+    workers[ i ].job = jobs[ index ].id;
+    workers[ i ].duration = 0;
+    workers[ i ].pending.clear();
+    workers[ i ].parser->reset();
+
+    qDebug().noquote() << "[vokoscreen] [jobs] start" << jobs[ index ].id << ":" << jobs[ index ].program << arguments.join( " " );
+    workers[ i ].process->start( jobs[ index ].program, arguments );
+  }
+
+  save();
+  emit changed();
+}
+
+
+void QvkJobQueue::finishJob( int worker, bool success )
+{
+  int index = indexOf( workers[ worker ].job );
+  workers[ worker ].job = 0;
+  if ( index < 0 )
+    return;
+
+  jobs[ index ].state = success ? QvkJob::Done : QvkJob::Failed;
+  if ( success == true )
+    jobs[ index ].percent = 100;
+  else
+    QFile::remove( jobs[ index ].destination );
+
+  qDebug().noquote() << "[vokoscreen] [jobs]" << jobs[ index ].id << ( success ? "done" : "failed" ) << jobs[ index ].destination;
+  startNext();
+}
+
+
+void QvkJobQueue::readyReadStandardOutput()
+{
+  int worker = workerOf( sender() );
+  if ( worker < 0 )
+    return;
+
+  workers[ worker ].parser->feed( workers[ worker ].process->readAllStandardOutput() );
+}
+
+
+/**
+ * Only the duration of the input is needed, "  Duration: 00:12:34.56, start: ..."
+ * The lines are looked at one by one, only an incomplete line is kept.
+ */
+void QvkJobQueue::readyReadStandardError()
+{
+  int worker = workerOf( sender() );
+  if ( worker < 0 )
+    return;
+
+  QByteArray data = workers[ worker ].process->readAllStandardError();
+  if ( workers[ worker ].duration > 0 )
+    return;
+
+  QByteArray &pending = workers[ worker ].pending;
+  pending.append( data );
+  QRegExp regExp( "Duration: (\\d+):(\\d+):(\\d+)\\.(\\d+)" );
+
+  int index;
+  while ( ( index = pending.indexOf( '\n' ) ) >= 0 )
+  {
+    QByteArray line = pending.left( index );
+    pending.remove( 0, index + 1 );
+    if ( regExp.indexIn( QString::fromLocal8Bit( line ) ) >= 0 )
+    {
+      workers[ worker ].duration = ( regExp.cap( 1 ).toLongLong() * 3600 + regExp.cap( 2 ).toLongLong() * 60 + regExp.cap( 3 ).toLongLong() ) * 1000000
+                                   + ( "0." + regExp.cap( 4 ) ).toDouble() * 1000000;
+      pending.clear();
+      return;
+    }
+  }
+
+  // A line without end that long is not the header
+  if ( pending.size() > 4096 )
+    pending.clear();
+}
+
+
+void QvkJobQueue::parserMetrics( QvkEncoderMetrics value )
+{
+  int worker = workerOf( sender() );
+  if ( ( worker < 0 ) or ( workers[ worker ].duration <= 0 ) )
+    return;
+
+  int index = indexOf( workers[ worker ].job );
+  if ( index < 0 )
+    return;
+
+  // 100 is only reached when ffmpeg has finished without error
+  int percent = qBound( 0, (int)( value.outTime * 100 / workers[ worker ].duration ), 99 );
+  if ( percent != jobs[ index ].percent )
+  {
+    jobs[ index ].percent = percent;
+    emit changed();
+  }
+}
+
+
+void QvkJobQueue::processFinished( int exitCode, QProcess::ExitStatus exitStatus )
+{
+  int worker = workerOf( sender() );
+  if ( worker < 0 )
+    return;
+
+  finishJob( worker, ( exitStatus == QProcess::NormalExit ) and ( exitCode == 0 ) );
+}
+
+
+/**
+ * If the process does not start there is no finished()
+ */
+void QvkJobQueue::processError( QProcess::ProcessError error )
+{
+  int worker = workerOf( sender() );
+  if ( ( worker < 0 ) or ( error != QProcess::FailedToStart ) )
+    return;
+
+  finishJob( worker, false );
+}
+
+
+int QvkJobQueue::workerOf( QObject *object )
+{
+  for ( int i = 0; i < workers.count(); i++ )
+    if ( ( workers[ i ].process == object ) or ( workers[ i ].parser == object ) )
+      return i;
+  return -1;
+}
+
+
+int QvkJobQueue::indexOf( int id )
+{
+  if ( id == 0 )
+    return -1;
+
+  for ( int i = 0; i < jobs.count(); i++ )
+    if ( jobs[ i ].id == id )
+      return i;
+  return -1;
+}
+
+
+/**
+ * A job that was running when vokoscreen ended begins again
+ */
+void QvkJobQueue::load()
+{
+  QFile file( jobFile );
+  if ( file.open( QIODevice::ReadOnly ) == false )
+    return;
+
+  QJsonArray array = QJsonDocument::fromJson( file.readAll() ).array();
+  file.close();
+
+  for ( int i = 0; i < array.count(); i++ )
+  {
+    QJsonObject object = array[ i ].toObject();
+    QvkJob job;
+    job.id = object.value( "id" ).toInt();
+    job.program = object.value( "program" ).toString();
+    job.source = object.value( "source" ).toString();
+    job.destination = object.value( "destination" ).toString();
+    job.state = object.value( "state" ).toInt();
+    job.percent = object.value( "percent" ).toInt();
+    QJsonArray arguments = object.value( "arguments" ).toArray();
+    for ( int j = 0; j < arguments.count(); j++ )
+      job.arguments << arguments[ j ].toString();
+
+    if ( ( job.state == QvkJob::Running ) or ( job.state == QvkJob::Paused ) )
+    {
+      QFile::remove( job.destination );
+      job.state = QvkJob::Waiting;
+      job.percent = 0;
+    }
+
+    nextId = qMax( nextId, job.id + 1 );
+    jobs << job;
+  }
+}
+
+
+/**
+ * QSaveFile, a crash while writing does not destroy the list
+ */
+void QvkJobQueue::save()
+{
+  QJsonArray array;
+  for ( int i = 0; i < jobs.count(); i++ )
+  {
+    QJsonObject object;
+    object.insert( "id", jobs[ i ].id );
+    object.insert( "program", jobs[ i ].program );
+    object.insert( "source", jobs[ i ].source );
+    object.insert( "destination", jobs[ i ].destination );
+    object.insert( "state", jobs[ i ].state );
+    object.insert( "percent", jobs[ i ].percent );
+    object.insert( "arguments", QJsonArray::fromStringList( jobs[ i ].arguments ) );
+    array << object;
+  }
+
+  QSaveFile file( jobFile );
+  if ( file.open( QIODevice::WriteOnly ) == false )
+  {
+    qDebug().noquote() << "[vokoscreen] [jobs] can not write" << jobFile;
+    return;
+  }
+  file.write( QJsonDocument( array ).toJson() );
+  file.commit();
+}
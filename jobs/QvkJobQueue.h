@@ -0,0 +1,92 @@
+#ifndef QvkJobQueue_H
+#define QvkJobQueue_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QList>
+
+#include "QvkJob.h"
+#include "QvkIdleProcess.h"
+#include "QvkProgressParser.h"
+
+/*
+ * Transcodes finished recordings in the background.
+ *
+ * The jobs are kept in a json file and survive a restart, a job that was
+ * running is started again. The workers are ffmpeg processes with idle
+ * priority for cpu and disk, their number depends on the cores. While a
+ * recording is running the workers are stopped with SIGSTOP.
+ * A pause of the user (DBus JobsPause) is kept apart from the pause of the
+ * recording, the workers go on when neither holds them.
+ */
+class QvkJobQueue: public QObject
+{
+    Q_OBJECT
+
+public:
+  QvkJobQueue( QString fileName );
+  virtual ~QvkJobQueue();
+
+  static QStringList profiles();
+  static QStringList profileArguments( QString profile );
+
+  int count();
+  QvkJob job( int index );
+  int workerCount();
+  bool isPaused();
+  QString summary();
+  QStringList list();
+
+
+public slots:
+  int add( QString program, QString source, QString profile );
+  void setPaused( bool value );
+  void setRecording( bool value );
+  void removeFinished();
+  void stop();
+
+
+signals:
+  void changed();
+
+
+private slots:
+  void readyReadStandardOutput();
+  void readyReadStandardError();
+  void processFinished( int exitCode, QProcess::ExitStatus exitStatus );
+  void processError( QProcess::ProcessError error );
+  void processStarted();
+  void parserMetrics( QvkEncoderMetrics value );
+
+
+private:
+  struct Worker
+  {
+    QvkIdleProcess *process;
+    QvkProgressParser *parser;
+    int job;         // id of the job, 0 if the worker is idle
+    qint64 duration; // microseconds, from the header of the input
+    QByteArray pending;
+  };
+
+  QString jobFile;
+  QList<QvkJob> jobs;
+  QList<Worker> workers;
+  int nextId;
+  bool paused;
+  bool userPaused;
+  bool recording;
+
+  void load();
+  void save();
+  void startNext();
+  void updatePaused();
+  void signalWorker( int worker );
+  void finishJob( int worker, bool success );
+  int workerOf( QObject *object );
+  int indexOf( int id );
+
+};
+
+#endif
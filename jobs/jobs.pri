@@ -0,0 +1,8 @@
+INCLUDEPATH += $$PWD
+DEPENDPATH  += $$PWD
+HEADERS     += $$PWD/QvkJob.h \
+               $$PWD/QvkIdleProcess.h \
+               $$PWD/QvkJobQueue.h
+
+SOURCES     += $$PWD/QvkIdleProcess.cpp \
+               $$PWD/QvkJobQueue.cpp
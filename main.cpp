@@ -18,6 +18,7 @@
 
 #include "screencast.h"
 #include "QvkDbus.h"
+#include "QvkHeadless.h"
 #include <QvkAllLoaded.h>
 
 #include <QDebug>
@@ -32,6 +33,14 @@ bool cameraLoaded = false;
 
 int main(int argc, char** argv)
 {
+    // Recording without GUI and without DBus, no QApplication is needed
+    if ( QvkHeadless::isHeadless( argc, argv ) )
+    {
+        QCoreApplication app(argc, argv);
+        QvkHeadless headless;
+        return headless.exec();
+    }
+
     QApplication app(argc, argv);
 
     bool isRunning = false;
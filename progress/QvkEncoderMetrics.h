@@ -0,0 +1,25 @@
+#ifndef QvkEncoderMetrics_H
+#define QvkEncoderMetrics_H
+
+#include <QMetaType>
+
+/*
+ * One progress report of the encoder, from ffmpeg -progress or from the native capture engine.
+ * speed is media time / wall time, below 1.0 the machine can not keep up.
+ */
+struct QvkEncoderMetrics
+{
+  qint64 frame = 0;
+  double fps = 0;
+  double speed = 0;
+  double bitrate = 0;     // kbit/s
+  qint64 totalSize = 0;   // bytes
+  qint64 outTime = 0;     // microseconds
+  qint64 dropFrames = 0;
+  qint64 dupFrames = 0;
+  bool end = false;
+};
+
+Q_DECLARE_METATYPE( QvkEncoderMetrics )
+
+#endif
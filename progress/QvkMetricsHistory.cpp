@@ -0,0 +1,76 @@
+#include "QvkMetricsHistory.h"
+
+QvkMetricsHistory::QvkMetricsHistory( int capacity )
+{
+  ring.resize( qMax( 1, capacity ) );
+  first = 0;
+  size = 0;
+}
+
+
+QvkMetricsHistory::~QvkMetricsHistory()
+{
+}
+
+
+void QvkMetricsHistory::append( const QvkEncoderMetrics &value )
+{
+  if ( size < ring.size() )
+  {
+    ring[ ( first + size ) % ring.size() ] = value;
+    size++;
+  }
+  else
+  {
+    ring[ first ] = value;
+    first = ( first + 1 ) % ring.size();
+  }
+}
+
+
+void QvkMetricsHistory::clear()
+{
+  first = 0;
+  size = 0;
+}
+
+
+int QvkMetricsHistory::count()
+{
+  return size;
+}
+
+
+/**
+ * index 0 is the oldest report
+ */
+QvkEncoderMetrics QvkMetricsHistory::at( int index )
+{
+  if ( ( index < 0 ) or ( index >= size ) )
+    return QvkEncoderMetrics();
+
+  return ring[ ( first + index ) % ring.size() ];
+}
+
+
+QvkEncoderMetrics QvkMetricsHistory::last()
+{
+  return at( size - 1 );
+}
+
+
+/**
+ * Average speed of the last reports, a single slow report is no problem
+ */
+double QvkMetricsHistory::averageSpeed( int reports )
+{
+  int n = qMin( reports, size );
+  if ( n == 0 )
+    return 0;
+
+  double sum = 0;
+  for ( int i = size - n; i < size; i++ )
+    sum += at( i ).speed;
+
+  return sum / n;
+}
@@ -0,0 +1,31 @@
+#ifndef QvkMetricsHistory_H
+#define QvkMetricsHistory_H
+
+#include <QVector>
+
+#include "QvkEncoderMetrics.h"
+
+/*
+ * Ring buffer with the last reports of the encoder, the oldest is overwritten.
+ */
+class QvkMetricsHistory
+{
+public:
+  QvkMetricsHistory( int capacity = 300 );
+  virtual ~QvkMetricsHistory();
+
+  void append( const QvkEncoderMetrics &value );
+  void clear();
+  int count();
+  QvkEncoderMetrics at( int index );
+  QvkEncoderMetrics last();
+  double averageSpeed( int reports );
+
+private:
+  QVector<QvkEncoderMetrics> ring;
+  int first;
+  int size;
+
+};
+
+#endif
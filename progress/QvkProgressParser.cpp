@@ -0,0 +1,92 @@
+#include "QvkProgressParser.h"
+
+QvkProgressParser::QvkProgressParser()
+{
+  qRegisterMetaType<QvkEncoderMetrics>( "QvkEncoderMetrics" );
+}
+
+
+QvkProgressParser::~QvkProgressParser()
+{
+}
+
+
+void QvkProgressParser::reset()
+{
+  pending.clear();
+  current = QvkEncoderMetrics();
+}
+
+
+void QvkProgressParser::feed( const QByteArray &data )
+{
+  pending.append( data );
+
+  int index;
+  while ( ( index = pending.indexOf( '\n' ) ) >= 0 )
+  {
+    parseLine( pending.left( index ).trimmed() );
+    pending.remove( 0, index + 1 );
+  }
+}
+
+
+/**
+ * Values that ffmpeg does not know yet are N/A, they stay at the last value.
+ * bitrate is e.g. "2345.6kbits/s", speed e.g. "1.01x".
+ */
+void QvkProgressParser::parseLine( const QByteArray &line )
+{
+  int index = line.indexOf( '=' );
+  if ( index < 1 )
+    return;
+
+  QByteArray key = line.left( index ).trimmed();
+  QByteArray value = line.mid( index + 1 ).trimmed();
+  if ( value == "N/A" )
+    return;
+
+  bool ok;
+  if ( key == "frame" )
+  {
+    current.frame = value.toLongLong();
+  }
+  else if ( key == "fps" )
+  {
+    current.fps = value.toDouble();
+  }
+  else if ( key == "bitrate" )
+  {
+    double bitrate = value.left( value.indexOf( "kbits" ) ).toDouble( &ok );
+    if ( ok == true )
+      current.bitrate = bitrate;
+  }
+  else if ( key == "total_size" )
+  {
+    current.totalSize = value.toLongLong();
+  }
+  else if ( ( key == "out_time_us" ) or ( key == "out_time_ms" ) )
+  {
+    // out_time_ms is also in microseconds, older ffmpeg versions have only this one
+    current.outTime = value.toLongLong();
+  }
+  else if ( key == "dup_frames" )
+  {
+    current.dupFrames = value.toLongLong();
+  }
+  else if ( key == "drop_frames" )
+  {
+    current.dropFrames = value.toLongLong();
+  }
+  else if ( key == "speed" )
+  {
+    double speed = value.left( value.indexOf( 'x' ) ).toDouble( &ok );
+    if ( ok == true )
+      current.speed = speed;
+  }
+  else if ( key == "progress" )
+  {
+    current.end = ( value == "end" );
+    emit metrics( current );
+  }
+}
@@ -0,0 +1,39 @@
+#ifndef QvkProgressParser_H
+#define QvkProgressParser_H
+
+#include <QObject>
+#include <QByteArray>
+
+#include "QvkEncoderMetrics.h"
+
+/*
+ * Parses the output of ffmpeg -progress pipe:N.
+ * ffmpeg writes blocks of key=value lines, every block ends with progress=continue
+ * or progress=end. The data can be given in chunks of any size, a line that is not
+ * complete is kept until the rest arrives.
+ */
+class QvkProgressParser: public QObject
+{
+    Q_OBJECT
+
+public:
+  QvkProgressParser();
+  virtual ~QvkProgressParser();
+
+  void feed( const QByteArray &data );
+  void reset();
+
+
+signals:
+  void metrics( QvkEncoderMetrics value );
+
+
+private:
+  QByteArray pending;
+  QvkEncoderMetrics current;
+
+  void parseLine( const QByteArray &line );
+
+};
+
+#endif
@@ -0,0 +1,98 @@
+#include "QvkSizeTracker.h"
+
+#include <QFileInfo>
+#include <QDir>
+
+QvkSizeTracker::QvkSizeTracker()
+{
+  finishedBytes = 0;
+  activeBytes = 0;
+  activeDirectory = false;
+
+  timer = new QTimer( this );
+  timer->setInterval( 1000 );
+  connect( timer, SIGNAL( timeout() ), this, SLOT( poll() ) );
+}
+
+
+QvkSizeTracker::~QvkSizeTracker()
+{
+}
+
+
+qint64 QvkSizeTracker::size()
+{
+  return finishedBytes + activeBytes;
+}
+
+
+void QvkSizeTracker::reset()
+{
+  timer->stop();
+  activeFile.clear();
+  finishedBytes = 0;
+  activeBytes = 0;
+  emit sizeChanged( 0 );
+}
+
+
+/**
+ * A segment that is still active is finished first
+ */
+void QvkSizeTracker::startSegment( QString fileName )
+{
+  finishSegment();
+  activeFile = fileName;
+  activeBytes = 0;
+  activeDirectory = QFileInfo( fileName ).isDir();
+  timer->start();
+}
+
+
+void QvkSizeTracker::finishSegment()
+{
+  if ( activeFile.isEmpty() )
+    return;
+
+  timer->stop();
+  poll();
+  if ( activeDirectory == false )
+  {
+    finishedBytes += activeBytes;
+    activeBytes = 0;
+  }
+  activeFile.clear();
+}
+
+
+/**
+ * Files that have left the directory of the active segment, e.g. the chunks of a finished segment
+ */
+void QvkSizeTracker::addBytes( qint64 bytes )
+{
+  finishedBytes += bytes;
+  if ( activeFile.isEmpty() )
+    emit sizeChanged( size() );
+  else
+    poll();
+}
+
+
+void QvkSizeTracker::poll()
+{
+  if ( activeFile.isEmpty() )
+    return;
+
+  if ( activeDirectory == true )
+  {
+    activeBytes = 0;
+    QFileInfoList list = QDir( activeFile ).entryInfoList( QDir::Files );
+    for ( int i = 0; i < list.size(); i++ )
+      activeBytes += list[ i ].size();
+  }
+  else
+  {
+    activeBytes = QFileInfo( activeFile ).size();
+  }
+  emit sizeChanged( size() );
+}
@@ -0,0 +1,53 @@
+#ifndef QvkSizeTracker_H
+#define QvkSizeTracker_H
+
+#include <QObject>
+#include <QTimer>
+#include <QString>
+
+/*
+ * Size of a recording that consists of one or more segments.
+ * The size of a finished segment is taken once and added up, only the
+ * segment that is written at the moment is checked, once per second.
+ *
+ * A segment can also be a directory, e.g. the chunks of the segment mode or
+ * the ring of the instant replay. Its files are counted together and it is
+ * not added up, its files come and go. Files that are moved out of it
+ * for good are added up with addBytes().
+ */
+class QvkSizeTracker: public QObject
+{
+    Q_OBJECT
+
+public:
+  QvkSizeTracker();
+  virtual ~QvkSizeTracker();
+
+  qint64 size();
+
+
+public slots:
+  void reset();
+  void startSegment( QString fileName );
+  void finishSegment();
+  void addBytes( qint64 bytes );
+
+
+signals:
+  void sizeChanged( qint64 bytes );
+
+
+private slots:
+  void poll();
+
+
+private:
+  QTimer *timer;
+  QString activeFile;
+  qint64 finishedBytes;
+  qint64 activeBytes;
+  bool activeDirectory;
+
+};
+
+#endif
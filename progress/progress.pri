@@ -0,0 +1,10 @@
+INCLUDEPATH += $$PWD
+DEPENDPATH  += $$PWD
+HEADERS     += $$PWD/QvkEncoderMetrics.h \
+               $$PWD/QvkProgressParser.h \
+               $$PWD/QvkMetricsHistory.h \
+               $$PWD/QvkSizeTracker.h
+
+SOURCES     += $$PWD/QvkProgressParser.cpp \
+               $$PWD/QvkMetricsHistory.cpp \
+               $$PWD/QvkSizeTracker.cpp
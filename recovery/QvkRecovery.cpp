@@ -0,0 +1,170 @@
+#include "QvkRecovery.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDebug>
+
+#include <signal.h>
+#include <errno.h>
+
+QvkRecovery::QvkRecovery()
+{
+  lockFile = NULL;
+
+  mergeJob = new QvkMergeJob();
+  connect( mergeJob, SIGNAL( finished( QString, bool ) ), this, SLOT( mergeFinished( QString, bool ) ) );
+}
+
+
+/**
+ * The lock of the temp location is held until vokoscreen ends
+ */
+QvkRecovery::~QvkRecovery()
+{
+  delete mergeJob;
+  delete lockFile;
+}
+
+
+bool QvkRecovery::isBusy()
+{
+  return mergeJob->isBusy() or ( directories.isEmpty() == false );
+}
+
+
+void QvkRecovery::waitForFinished()
+{
+  while ( mergeJob->isBusy() )
+    mergeJob->waitForFinished();
+}
+
+
+/**
+ * tempLocation: the directory where a recording is written, the merges,
+ * segments and small copies are beside it with -merge-, -segment- and
+ * -preview in the name.
+ *
+ * busyDirectories: are in use by running jobs of this vokoscreen
+ */
+void QvkRecovery::start( QString program, QString tempLocation, QString movieLocation, QStringList busyDirectories )
+{
+  ffmpegProgram = program;
+  moviePath = movieLocation;
+
+  removeReplayRings( QDir::tempPath() );
+  removeReplayRings( "/dev/shm" );
+
+  // A lock of a process that does not exist anymore is removed by QLockFile
+  delete lockFile;
+  lockFile = new QLockFile( tempLocation + ".lock" );
+  lockFile->setStaleLockTime( 0 );
+  if ( lockFile->tryLock( 0 ) == false )
+  {
+    qDebug().noquote() << "[vokoscreen] [recovery] an other vokoscreen records in" << tempLocation;
+    emit finished();
+    return;
+  }
+
+  QFileInfo tempInfo( tempLocation );
+  QDir parent( tempInfo.path() );
+  QStringList candidates;
+  candidates << tempLocation;
+  QStringList nameFilters;
+  nameFilters << tempInfo.fileName() + "-merge-*" << tempInfo.fileName() + "-segment-*" << tempInfo.fileName() + "-preview*";
+  QStringList stringList = parent.entryList( nameFilters, QDir::Dirs | QDir::Hidden | QDir::NoDotAndDotDot, QDir::Time | QDir::Reversed );
+  for ( int i = 0; i < stringList.size(); ++i )
+    candidates << parent.absoluteFilePath( stringList[ i ] );
+
+  for ( int i = 0; i < busyDirectories.size(); ++i )
+    candidates.removeAll( QFileInfo( busyDirectories[ i ] ).absoluteFilePath() );
+
+  // Lists of ffmpeg and of an old merge are not part of the video
+  directories.clear();
+  for ( int i = 0; i < candidates.size(); ++i )
+  {
+    QDir dir( candidates[ i ] );
+    if ( dir.exists() == false )
+      continue;
+
+    QStringList lists = dir.entryList( QStringList() << "*.csv" << "mergeFile.txt", QDir::Files );
+    for ( int j = 0; j < lists.size(); ++j )
+      dir.remove( lists[ j ] );
+
+    if ( dir.entryList( QDir::Files ).isEmpty() )
+    {
+      if ( candidates[ i ] != tempLocation )
+        QDir().rmdir( candidates[ i ] );
+      continue;
+    }
+    directories << candidates[ i ];
+  }
+
+  if ( directories.isEmpty() )
+  {
+    emit finished();
+    return;
+  }
+
+  qDebug().noquote() << "[vokoscreen] [recovery] found" << directories.size() << "recordings that were not saved";
+  startNext();
+}
+
+
+/**
+ * The name of the recovered video has the time of the last change of the recording
+ */
+void QvkRecovery::startNext()
+{
+  if ( directories.isEmpty() )
+  {
+    emit finished();
+    return;
+  }
+
+  QString directory = directories.takeFirst();
+  QDir dir( directory );
+  QFileInfoList list = dir.entryInfoList( QDir::Files, QDir::Time );
+  if ( list.isEmpty() )
+  {
+    startNext();
+    return;
+  }
+
+  QString suffix = list.first().suffix();
+  QString name = "vokoscreen-recovered-" + list.first().lastModified().toString( "yyyy-MM-dd_hh-mm-ss" );
+
+  QString destination = moviePath + QDir::separator() + name + "." + suffix;
+  for ( int i = 2; QFile::exists( destination ); i++ )
+    destination = moviePath + QDir::separator() + name + "-" + QString::number( i ) + "." + suffix;
+
+  qDebug().noquote() << "[vokoscreen] [recovery]" << list.size() << "files in" << directory << "to" << destination;
+  mergeJob->start( ffmpegProgram, directory, destination );
+}
+
+
+void QvkRecovery::mergeFinished( QString destination, bool success )
+{
+  emit recovered( destination, success );
+  startNext();
+}
+
+
+/**
+ * The instant replay is thrown away, only a ring of a dead process is removed
+ */
+void QvkRecovery::removeReplayRings( QString path )
+{
+  QDir dir( path );
+  QStringList stringList = dir.entryList( QStringList() << "vokoscreen-replay-*", QDir::Dirs | QDir::NoDotAndDotDot );
+  for ( int i = 0; i < stringList.size(); ++i )
+  {
+    qint64 pid = stringList[ i ].mid( QString( "vokoscreen-replay-" ).length() ).section( '-', 0, 0 ).toLongLong();
+    if ( ( pid <= 0 ) or ( kill( (pid_t)pid, 0 ) == 0 ) or ( errno != ESRCH ) )
+      continue;
+
+    qDebug().noquote() << "[vokoscreen] [recovery] remove replay ring" << dir.absoluteFilePath( stringList[ i ] );
+    QDir( dir.absoluteFilePath( stringList[ i ] ) ).removeRecursively();
+  }
+}
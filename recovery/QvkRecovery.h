@@ -0,0 +1,56 @@
+#ifndef QvkRecovery_H
+#define QvkRecovery_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QLockFile>
+
+#include "QvkMergeJob.h"
+
+/*
+ * Recovers recordings that are left over from a crash.
+ *
+ * The temp location of a running vokoscreen is locked. At startup the
+ * temp location, merges that have failed, segments that were not joined
+ * and small copies are remuxed with stream copy into the movie location, one after
+ * the other in the background. Replay rings of dead processes are removed.
+ */
+class QvkRecovery: public QObject
+{
+    Q_OBJECT
+
+public:
+  QvkRecovery();
+  virtual ~QvkRecovery();
+
+  bool isBusy();
+  void waitForFinished();
+
+
+public slots:
+  void start( QString program, QString tempLocation, QString movieLocation, QStringList busyDirectories = QStringList() );
+
+
+signals:
+  void recovered( QString destination, bool success );
+  void finished();
+
+
+private slots:
+  void mergeFinished( QString destination, bool success );
+
+
+private:
+  QvkMergeJob *mergeJob;
+  QLockFile *lockFile;
+  QString ffmpegProgram;
+  QString moviePath;
+  QStringList directories;
+
+  void startNext();
+  void removeReplayRings( QString path );
+
+};
+
+#endif
@@ -0,0 +1,5 @@
+INCLUDEPATH += $$PWD
+DEPENDPATH  += $$PWD
+HEADERS     += $$PWD/QvkRecovery.h
+
+SOURCES     += $$PWD/QvkRecovery.cpp
@@ -0,0 +1,195 @@
+#include "QvkReplayBuffer.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QCoreApplication>
+#include <QDebug>
+
+#include <sys/time.h>
+
+static const int segmentTime = 2; // seconds
+
+QvkReplayBuffer::QvkReplayBuffer()
+{
+  seconds = 60;
+  saveCount = 0;
+
+  // Memory is faster and does not wear the disk, the ring is small
+  QString base = QDir::tempPath();
+  QFileInfo shm( "/dev/shm" );
+  if ( shm.isDir() and shm.isWritable() )
+    base = "/dev/shm";
+  ringDirectory = base + QDir::separator() + "vokoscreen-replay-" + QString::number( QCoreApplication::applicationPid() );
+
+  mergeJob = new QvkMergeJob();
+  connect( mergeJob, SIGNAL( finished( QString, bool ) ), this, SLOT( mergeFinished( QString, bool ) ) );
+}
+
+
+QvkReplayBuffer::~QvkReplayBuffer()
+{
+  delete mergeJob;
+  close();
+}
+
+
+void QvkReplayBuffer::setDuration( int value )
+{
+  seconds = qMax( segmentTime, value );
+}
+
+
+int QvkReplayBuffer::duration()
+{
+  return seconds;
+}
+
+
+QString QvkReplayBuffer::directory()
+{
+  return ringDirectory;
+}
+
+
+bool QvkReplayBuffer::isSaving()
+{
+  return mergeJob->isBusy();
+}
+
+
+void QvkReplayBuffer::waitForFinished()
+{
+  mergeJob->waitForFinished();
+}
+
+
+/**
+ * Complete segments that are saved and the newest that is still written
+ */
+int QvkReplayBuffer::segmentCount()
+{
+  return ( seconds + segmentTime - 1 ) / segmentTime + 1;
+}
+
+
+/**
+ * Output options for ffmpeg instead of -f and the file name.
+ * The ring has one segment more than is saved, the segment that is
+ * overwritten next is never copied.
+ */
+QStringList QvkReplayBuffer::segmentArguments()
+{
+  QStringList list;
+  list << "-force_key_frames" << "expr:gte(t,n_forced*" + QString::number( segmentTime ) + ")";
+  list << "-f" << "segment";
+  list << "-segment_time" << QString::number( segmentTime );
+  list << "-segment_wrap" << QString::number( segmentCount() + 1 );
+  list << "-segment_format" << "matroska";
+  list << "-reset_timestamps" << "1";
+  list << ringDirectory + QDir::separator() + "replay-%03d.mkv";
+  return list;
+}
+
+
+/**
+ * Creates an empty ring directory
+ */
+bool QvkReplayBuffer::open()
+{
+  close();
+  if ( QDir().mkpath( ringDirectory ) == false )
+  {
+    qDebug().noquote() << "[vokoscreen] [replay] can not create" << ringDirectory;
+    return false;
+  }
+
+  qDebug().noquote() << "[vokoscreen] [replay] ring for" << seconds << "seconds in" << ringDirectory;
+  return true;
+}
+
+
+void QvkReplayBuffer::close()
+{
+  QDir dir( ringDirectory );
+  if ( dir.exists() == false )
+    return;
+
+  QStringList stringList = dir.entryList( QDir::Files );
+  for ( int i = 0; i < stringList.size(); ++i )
+    dir.remove( stringList[ i ] );
+  QDir().rmdir( ringDirectory );
+}
+
+
+/**
+ * The segments are copied first, ffmpeg goes on writing into the ring while they are joined.
+ * The copies get the time of the segments, QvkMergeJob joins in the order of the time.
+ * The newest segment is open, only the segments before it are saved.
+ */
+bool QvkReplayBuffer::save( QString program, QString destination )
+{
+  if ( mergeJob->isBusy() )
+  {
+    qDebug().noquote() << "[vokoscreen] [replay] a replay is saved at the moment";
+    return false;
+  }
+
+  QDir dir( ringDirectory );
+  QStringList stringList = dir.entryList( QStringList() << "replay-*.mkv", QDir::Files, QDir::Time );
+  if ( stringList.isEmpty() == false )
+    stringList.removeFirst();
+  if ( stringList.isEmpty() )
+  {
+    qDebug().noquote() << "[vokoscreen] [replay] nothing recorded";
+    return false;
+  }
+
+  saveCount++;
+  QString saveDirectory = ringDirectory + "-save-" + QString::number( saveCount );
+  QDir().mkpath( saveDirectory );
+
+  int count = qMin( segmentCount() - 1, stringList.size() );
+  int copied = 0;
+  for ( int i = count - 1; i >= 0; i-- )
+  {
+    QString source = ringDirectory + QDir::separator() + stringList[ i ];
+    QString target = saveDirectory + QDir::separator() + stringList[ i ];
+    if ( QFile::copy( source, target ) == false )
+    {
+      qDebug().noquote() << "[vokoscreen] [replay] can not copy" << source;
+      continue;
+    }
+    copied++;
+
+    qint64 msecs = QFileInfo( source ).lastModified().toMSecsSinceEpoch();
+    struct timeval times[ 2 ];
+    times[ 0 ].tv_sec = msecs / 1000;
+    times[ 0 ].tv_usec = ( msecs % 1000 ) * 1000;
+    times[ 1 ] = times[ 0 ];
+    utimes( QFile::encodeName( target ).constData(), times );
+  }
+
+  if ( copied == 0 )
+  {
+    QDir( saveDirectory ).removeRecursively();
+    return false;
+  }
+
+  qDebug().noquote() << "[vokoscreen] [replay] save" << copied << "segments to" << destination;
+  mergeJob->start( program, saveDirectory, destination );
+  return true;
+}
+
+
+/**
+ * The copies are in memory, they are not kept when the join fails
+ */
+void QvkReplayBuffer::mergeFinished( QString destination, bool success )
+{
+  if ( success == false )
+    QDir( mergeJob->getWorkDirectory() ).removeRecursively();
+
+  emit saved( destination, success );
+}
@@ -0,0 +1,59 @@
+#ifndef QvkReplayBuffer_H
+#define QvkReplayBuffer_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+#include "QvkMergeJob.h"
+
+/*
+ * Ring of short segments for the instant replay.
+ *
+ * ffmpeg writes with the segment muxer into a small ring of files in
+ * memory (/dev/shm) or in the temp location, each segment begins with a
+ * keyframe. save() copies the newest complete segments and joins them with
+ * stream copy, there is no second encoding. The segment that ffmpeg writes
+ * at the moment is not copied, it would end the clip with a cut frame.
+ */
+class QvkReplayBuffer: public QObject
+{
+    Q_OBJECT
+
+public:
+  QvkReplayBuffer();
+  virtual ~QvkReplayBuffer();
+
+  void setDuration( int seconds );
+  int duration();
+  QString directory();
+  QStringList segmentArguments();
+  bool isSaving();
+  void waitForFinished();
+
+
+public slots:
+  bool open();
+  void close();
+  bool save( QString program, QString destination );
+
+
+signals:
+  void saved( QString destination, bool success );
+
+
+private slots:
+  void mergeFinished( QString destination, bool success );
+
+
+private:
+  QvkMergeJob *mergeJob;
+  QString ringDirectory;
+  int seconds;
+  int saveCount;
+
+  int segmentCount();
+
+};
+
+#endif
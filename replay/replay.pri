@@ -0,0 +1,5 @@
+INCLUDEPATH += $$PWD
+DEPENDPATH  += $$PWD
+HEADERS     += $$PWD/QvkReplayBuffer.h
+
+SOURCES     += $$PWD/QvkReplayBuffer.cpp
@@ -47,8 +47,8 @@ screencast::screencast()
     myUi.setupUi( this );
     myUi.ListWidgetLogVokoscreen->setVisible( false );
 
-    QvkDbus *dbus = new QvkDbus( myUi );
-    connect( dbus, SIGNAL( close() ), this, SLOT( close() ) );
+    vkDbus = new QvkDbus( myUi );
+    connect( vkDbus, SIGNAL( close() ), this, SLOT( close() ) );
     
     myLog = new QvkLog();
     qInstallMessageHandler( myMessageOutput );
@@ -84,9 +84,12 @@ screencast::screencast()
     
     qDebug( " " );
 
+    startupTasks = new QvkStartupTasks();
+    connect( startupTasks, SIGNAL( finished( QString, QVariant ) ), this, SLOT( startupTaskFinished( QString, QVariant ) ) );
     searchExternalPrograms();
 
     pause = false;
+    stopping = false;
     firststartWininfo = false;
 
     // Tab 1 Screen options ***************************************************
@@ -190,6 +193,14 @@ screencast::screencast()
     statusBarLabelFpsSettings = new QLabel();
     statusBarLabelFpsSettings->setToolTip( tr( "Settings fps" ) );
 
+    statusBarLabelSpeed = new QLabel();
+    statusBarLabelSpeed->setText( "0.00x" );
+    statusBarLabelSpeed->setToolTip( tr( "Encoder speed, below 1.00x the computer can not keep up" ) );
+
+    statusBarLabelDrop = new QLabel();
+    statusBarLabelDrop->setText( "0/0" );
+    statusBarLabelDrop->setToolTip( tr( "Dropped/duplicated frames" ) );
+
     QLabel * LabelTemp = new QLabel();
     myUi.statusBar->addWidget( LabelTemp, 0 );
     
@@ -201,6 +212,8 @@ screencast::screencast()
     myUi.statusBar->addWidget( statusBarLabelFormat, 2 );
     myUi.statusBar->addWidget( statusBarLabelAudio, 2 );
     myUi.statusBar->addWidget( statusBarLabelFpsSettings, 2 );
+    myUi.statusBar->addWidget( statusBarLabelSpeed, 2 );
+    myUi.statusBar->addWidget( statusBarLabelDrop, 2 );
     
     
     // Tab 2 Audio options ****************************************
@@ -257,9 +270,14 @@ screencast::screencast()
     
     connect( myUi.SaveVideoPathPushButton, SIGNAL(clicked() ), SLOT( saveVideoPath() ) );
 
-    // Leeren Konstruktor aufrufen und dann wird über den Slot recorderLineEditTextChanged die Formate und Codecs ermittelt
-    // so bald das Feld RecorderLineEdit geändert wird
-    formatsAndCodecs = new QvkFormatsAndCodecs();
+    // Die Formate und Codecs werden über den Slot recorderProbe ermittelt, aus dem Cache oder im Hintergrund.
+    // Beim Tippen im Feld RecorderLineEdit erst wenn eine kurze Zeit keine Taste mehr gedrückt wurde
+    formatsAndCodecs = new QvkFormatsAndCodecs( vkSettings.getProgName() );
+    connect( formatsAndCodecs, SIGNAL( changed() ), SLOT( formatsAndCodecsChanged() ) );
+    recorderTimer = new QTimer( this );
+    recorderTimer->setSingleShot( true );
+    recorderTimer->setInterval( 500 );
+    connect( recorderTimer, SIGNAL( timeout() ), SLOT( recorderProbe() ) );
     connect( myUi.RecorderLineEdit, SIGNAL( textChanged( QString ) ), SLOT( recorderLineEditTextChanged( QString ) ) );
 
     if ( vkSettings.isVokoscreenWithLibs() == true )
@@ -272,6 +290,7 @@ screencast::screencast()
       myUi.RecorderLineEdit->setText( getFileWithPath( vkSettings.getRecorder() ) );
       connect( myUi.selectRecorderPushButton, SIGNAL(clicked() ), SLOT( selectRecorder() ) );
     }
+    recorderProbe();
     
     myUi.SystrayCheckBox->setCheckState( Qt::Checked );
     connect( myUi.SystrayCheckBox, SIGNAL( stateChanged( int ) ), SLOT( stateChangedSystray( int ) ) );
@@ -344,10 +363,8 @@ screencast::screencast()
     
     myUi.sendPushButton->setToolTip( tr( "Send Video" ) );
     connect( myUi.sendPushButton, SIGNAL( clicked() ), SLOT( send() ) );
-    if ( searchProgramm( "xdg-email" ) )
-      myUi.sendPushButton->setEnabled( true );
-    else
-      myUi.sendPushButton->setEnabled( false );
+    // Is enabled when xdg-email is found, see startupTaskFinished
+    myUi.sendPushButton->setEnabled( false );
     
     myUi.LogPushButton->setIcon ( QIcon::fromTheme( "dialog-information", QIcon( ":/pictures/about.png" ) ) );
     connect( myUi.LogPushButton, SIGNAL( clicked() ), this, SLOT( VisibleHideKonsole() ) );
@@ -361,8 +378,8 @@ screencast::screencast()
     connect( myUi.updateButton, SIGNAL( clicked() ), SLOT( showHomepage() ) );  
   #endif
 
-    searchVideoPlayer();
-    searchGIFPlayer();
+    // The players are searched when the tab is shown or the video is played, see setVideoPlayer and setGIFPlayer
+    myUi.VideoplayerComboBox->insertItem( -1 , QIcon( ":/pictures/videooptionen.png" ), "Standard system player" );
     
     // Read Settings
     myUi.AudioOnOffCheckbox->setCheckState( Qt::CheckState( vkSettings.getAudioOnOff() ) );
@@ -389,18 +406,6 @@ screencast::screencast()
     else
       PathMoviesLocation();
 
-    int x = myUi.VideoplayerComboBox->findText( vkSettings.getVideoPlayer(), Qt::MatchExactly );
-    if ( x == -1 )
-      myUi.VideoplayerComboBox->setCurrentIndex( 0 );
-    else
-      myUi.VideoplayerComboBox->setCurrentIndex( x );
-      
-    x = myUi.GIFplayerComboBox->findText( vkSettings.getGIFPlayer(), Qt::MatchExactly );
-    if ( x == -1 )
-      myUi.GIFplayerComboBox->setCurrentIndex( 0 );
-    else
-      myUi.GIFplayerComboBox->setCurrentIndex( x );
-      
     myUi.x264LosslessCheckBox->setCheckState( Qt::CheckState( vkSettings.getX264Lossless() )  );
     
     myUi.MinimizedCheckBox->setCheckState( Qt::CheckState( vkSettings.getMinimized() ) );
@@ -417,6 +422,84 @@ screencast::screencast()
     statusBarLabelFpsSettings->setText( QString::number( myUi.FrameSpinBox->value() ) );
 
     myUi.HideMouseCheckbox->setCheckState( Qt::CheckState( vkSettings.getHideMouse()) );
+    myUi.NativeCaptureCheckBox->setCheckState( Qt::CheckState( vkSettings.getNativeCapture() ) );
+    myUi.NativeCaptureCheckBox->setToolTip( tr( "Record the screen without a ffmpeg process, no audio" ) );
+    myUi.VariableFrameRateCheckBox->setCheckState( Qt::CheckState( vkSettings.getVariableFrameRate() ) );
+    myUi.VariableFrameRateCheckBox->setToolTip( tr( "A new frame is only recorded when something on the screen has changed" ) );
+    myUi.VariableFrameRateCheckBox->setEnabled( myUi.NativeCaptureCheckBox->isChecked() );
+    connect( myUi.NativeCaptureCheckBox, SIGNAL( toggled( bool ) ), myUi.VariableFrameRateCheckBox, SLOT( setEnabled( bool ) ) );
+
+    myUi.ThreadingComboBox->addItem( tr( "Auto" ), QvkThreadPolicy::Auto );
+    myUi.ThreadingComboBox->addItem( tr( "Frame" ), QvkThreadPolicy::Frame );
+    myUi.ThreadingComboBox->addItem( tr( "Slice" ), QvkThreadPolicy::Slice );
+    myUi.ThreadingComboBox->setCurrentIndex( qBound( 0, vkSettings.getThreading(), 2 ) );
+    myUi.ThreadingComboBox->setToolTip( tr( "Auto: frame threading for x264, slice threading for the other codecs" ) );
+    myUi.ReservedCoresSpinBox->setRange( 0, QvkThreadPolicy::cores() - 1 );
+    myUi.ReservedCoresSpinBox->setValue( vkSettings.getReservedCores() );
+    myUi.ReservedCoresSpinBox->setToolTip( tr( "Cores that are not used by the encoder, they are left for the X server and the desktop" )
+                                           + " (" + QString::number( QvkThreadPolicy::cores() ) + " " + tr( "cores" ) + ")" );
+
+    benchmark = new QvkBenchmark( vkSettings.getProgName() );
+    connect( benchmark, SIGNAL( progress( QString, QString, int, int ) ), this, SLOT( benchmarkProgress( QString, QString, int, int ) ) );
+    connect( benchmark, SIGNAL( finished() ), this, SLOT( benchmarkFinished() ) );
+    connect( benchmark, SIGNAL( error( QString ) ), this, SLOT( benchmarkError( QString ) ) );
+    connect( myUi.BenchmarkPushButton, SIGNAL( clicked() ), this, SLOT( benchmarkClicked() ) );
+    myUi.BenchmarkPushButton->setToolTip( tr( "Measure the speed of the codecs and presets on this computer, the best preset is then used for recording" ) );
+
+    adaptive = new QvkAdaptiveController();
+    connect( adaptive, SIGNAL( levelChanged() ), this, SLOT( adaptiveLevelChanged() ) );
+    myUi.AdaptiveCheckBox->setCheckState( Qt::CheckState( vkSettings.getAdaptive() ) );
+    myUi.AdaptiveCheckBox->setToolTip( tr( "When the encoder is too slow, the preset and the frame rate are lowered step by step and raised again when there is headroom" ) );
+
+    replay = false;
+    replayBuffer = new QvkReplayBuffer();
+    connect( replayBuffer, SIGNAL( saved( QString, bool ) ), this, SLOT( replaySaved( QString, bool ) ) );
+    myUi.ReplayCheckBox->setCheckState( Qt::CheckState( vkSettings.getReplay() ) );
+    myUi.ReplayCheckBox->setToolTip( tr( "Records continuously into a ring in memory, CTRL+SHIFT+F7 saves the last seconds as a video" ) );
+    myUi.ReplaySpinBox->setValue( vkSettings.getReplaySeconds() );
+    myUi.ReplaySpinBox->setToolTip( tr( "Length of the instant replay" ) );
+
+    myUi.SegmentCheckBox->setCheckState( Qt::CheckState( vkSettings.getSegment() ) );
+    myUi.SegmentCheckBox->setToolTip( tr( "Long recordings are saved as numbered files, a finished file is saved while the recording goes on" ) );
+    myUi.SegmentMinutesSpinBox->setValue( vkSettings.getSegmentMinutes() );
+    myUi.SegmentMinutesSpinBox->setToolTip( tr( "Maximum length of a file" ) );
+    myUi.SegmentSizeSpinBox->setValue( vkSettings.getSegmentSize() );
+    myUi.SegmentSizeSpinBox->setToolTip( tr( "Maximum size of a file" ) );
+
+    myUi.PreviewCheckBox->setCheckState( Qt::CheckState( vkSettings.getPreview() ) );
+    myUi.PreviewCheckBox->setToolTip( tr( "A second, small video is recorded at the same time, e.g. for the web" ) );
+    myUi.PreviewSpinBox->setValue( vkSettings.getPreviewHeight() );
+    myUi.PreviewSpinBox->setToolTip( tr( "Height of the small video" ) );
+
+    // The jobs are kept beside the settings
+    QSettings jobSettings( vkSettings.getProgName(), vkSettings.getProgName() );
+    jobQueue = new QvkJobQueue( QFileInfo( jobSettings.fileName() ).absolutePath() + QDir::separator() + "jobs.json" );
+    connect( jobQueue, SIGNAL( changed() ), this, SLOT( jobsChanged() ) );
+    connect( myUi.JobsClearPushButton, SIGNAL( clicked() ), jobQueue, SLOT( removeFinished() ) );
+    vkDbus->setJobQueue( jobQueue );
+    myUi.TranscodeComboBox->addItems( QvkJobQueue::profiles() );
+    myUi.TranscodeComboBox->setCurrentIndex( qMax( 0, myUi.TranscodeComboBox->findText( vkSettings.getTranscodeProfile() ) ) );
+    myUi.TranscodeCheckBox->setCheckState( Qt::CheckState( vkSettings.getTranscode() ) );
+    myUi.TranscodeCheckBox->setToolTip( tr( "Record with a fast codec and compress the video afterwards, with idle priority and not while recording" ) );
+    myUi.JobsClearPushButton->setToolTip( tr( "Remove the finished jobs from the list" ) );
+    jobsChanged();
+
+    myUi.FollowCursorCheckBox->setCheckState( Qt::CheckState( vkSettings.getFollowCursor() ) );
+    myUi.FollowCursorCheckBox->setToolTip( tr( "In area mode the recorded area glides after the mouse, e.g. a 1920x1080 video of a 4K screen" ) );
+
+    myUi.ScreenStreamsComboBox->addItem( tr( "Files" ) );
+    myUi.ScreenStreamsComboBox->addItem( tr( "Tracks in one file" ) );
+    myUi.ScreenStreamsComboBox->setCurrentIndex( vkSettings.getScreenStreamsMode() );
+    myUi.ScreenStreamsCheckBox->setCheckState( Qt::CheckState( vkSettings.getScreenStreams() ) );
+    myUi.ScaleComboBox->addItem( tr( "Original" ), 100 );
+    myUi.ScaleComboBox->addItem( tr( "Logical size (HiDPI)" ), 0 );
+    myUi.ScaleComboBox->addItem( "75 %", 75 );
+    myUi.ScaleComboBox->addItem( "66 %", 66 );
+    myUi.ScaleComboBox->addItem( "50 %", 50 );
+    myUi.ScaleComboBox->addItem( "33 %", 33 );
+    myUi.ScaleComboBox->setCurrentIndex( qMax( 0, myUi.ScaleComboBox->findData( vkSettings.getScalePercent() ) ) );
+    myUi.ScaleComboBox->setToolTip( tr( "The video is smaller than the screen, e.g. a 4K screen as 1080p. The native capture engine scales right after the grab" ) );
+    myUi.ScreenStreamsCheckBox->setToolTip( tr( "Fullscreen with all screens: every screen is recorded by its own threads, without black filler between the screens" ) );
 
     move( vkSettings.getX(),vkSettings.getY() );
 
@@ -432,9 +515,66 @@ screencast::screencast()
     connect( SystemCall, SIGNAL( stateChanged ( QProcess::ProcessState) ),this, SLOT( stateChanged( QProcess::ProcessState) ) );
     connect( SystemCall, SIGNAL( error( QProcess::ProcessError) ),        this, SLOT( error( QProcess::ProcessError) ) );
     connect( SystemCall, SIGNAL( readyReadStandardError() ),              this, SLOT( readyReadStandardError() ) );
-
-    windowMoveTimer = new QTimer( this );
-    connect( windowMoveTimer, SIGNAL( timeout() ), this, SLOT( windowMove() ) );
+    connect( SystemCall, SIGNAL( readyReadStandardOutput() ),             this, SLOT( readyReadStandardOutput() ) );
+
+    progressParser = new QvkProgressParser();
+    connect( progressParser, SIGNAL( metrics( QvkEncoderMetrics ) ), this, SLOT( encoderMetrics( QvkEncoderMetrics ) ) );
+
+    sizeTracker = new QvkSizeTracker();
+    connect( sizeTracker, SIGNAL( sizeChanged( qint64 ) ), this, SLOT( recordSizeChanged( qint64 ) ) );
+
+    nativeCapture = false;
+    nativeThreads = 1;
+    captureController = new QvkCaptureController();
+    connect( captureController, SIGNAL( started() ),                        this, SLOT( nativeCaptureStarted() ) );
+    connect( captureController, SIGNAL( stopped() ),                        this, SLOT( nativeCaptureStopped() ) );
+    connect( captureController, SIGNAL( paused() ),                         this, SLOT( nativeCapturePaused() ) );
+    connect( captureController, SIGNAL( resumed() ),                        this, SLOT( nativeCaptureResumed() ) );
+    connect( captureController, SIGNAL( error( QString ) ),                 this, SLOT( nativeCaptureError( QString ) ) );
+    connect( captureController, SIGNAL( metrics( QvkEncoderMetrics ) ),     this, SLOT( encoderMetrics( QvkEncoderMetrics ) ) );
+
+    // Every screen with its own capture thread and encoder thread
+    screenRecorder = new QvkMultiSessionRecorder( 0 );
+    connect( screenRecorder, SIGNAL( started() ),                           this, SLOT( nativeCaptureStarted() ) );
+    connect( screenRecorder, SIGNAL( stopped() ),                           this, SLOT( nativeCaptureStopped() ) );
+    connect( screenRecorder, SIGNAL( paused() ),                            this, SLOT( nativeCapturePaused() ) );
+    connect( screenRecorder, SIGNAL( resumed() ),                           this, SLOT( nativeCaptureResumed() ) );
+    connect( screenRecorder, SIGNAL( sessionStopped( int, QString ) ),      this, SLOT( screenStreamStopped( int, QString ) ) );
+    connect( screenRecorder, SIGNAL( totalMetrics( QvkEncoderMetrics ) ),   this, SLOT( encoderMetrics( QvkEncoderMetrics ) ) );
+
+    fileMover = new QvkFileMover();
+    connect( fileMover, SIGNAL( progress( int, qint64 ) ),   this, SLOT( finalizeProgress( int, qint64 ) ) );
+    connect( fileMover, SIGNAL( finished( QString, bool ) ), this, SLOT( finalizeFinished( QString, bool ) ) );
+
+    mergeJob = new QvkMergeJob();
+    connect( mergeJob, SIGNAL( progress( int, qint64 ) ),    this, SLOT( finalizeProgress( int, qint64 ) ) );
+    connect( mergeJob, SIGNAL( finished( QString, bool ) ),  this, SLOT( finalizeFinished( QString, bool ) ) );
+
+    preview = false;
+    previewMergeJob = new QvkMergeJob();
+    connect( previewMergeJob, SIGNAL( finished( QString, bool ) ), this, SLOT( finalizeFinished( QString, bool ) ) );
+    previewMover = new QvkFileMover();
+    connect( previewMover, SIGNAL( finished( QString, bool ) ), this, SLOT( finalizeFinished( QString, bool ) ) );
+
+    segmenting = false;
+    segmentRotator = new QvkSegmentRotator();
+    connect( segmentRotator, SIGNAL( progress( int, qint64 ) ),          this, SLOT( finalizeProgress( int, qint64 ) ) );
+    connect( segmentRotator, SIGNAL( segmentFinished( QString, bool ) ), this, SLOT( finalizeFinished( QString, bool ) ) );
+    connect( segmentRotator, SIGNAL( chunksMoved( qint64 ) ),            sizeTracker, SLOT( addBytes( qint64 ) ) );
+
+    // Recordings that were not saved because vokoscreen or ffmpeg has crashed
+    recovery = new QvkRecovery();
+    connect( recovery, SIGNAL( recovered( QString, bool ) ), this, SLOT( recoveryFinished( QString, bool ) ) );
+    // PathTempLocation() sets moviePath
+    const QString temp = PathTempLocation();
+    recovery->start( myUi.RecorderLineEdit->displayText(), temp, moviePath );
+
+    windowMovePaused = false;
+    windowWatcher = new QvkWindowWatcher();
+    connect( windowWatcher, SIGNAL( moveStarted() ),  this, SLOT( windowMoveStarted() ) );
+    connect( windowWatcher, SIGNAL( moved() ),        this, SLOT( windowMoved() ) );
+    connect( windowWatcher, SIGNAL( moveFinished() ), this, SLOT( windowMoveFinished() ) );
+    connect( windowWatcher, SIGNAL( closed() ),       this, SLOT( windowClosed() ) );
 
     myregionselection = new QvkRegionController();
     connect( myUi.areaResetButton,       SIGNAL( clicked() ), this, SLOT( areaReset() ) );
@@ -519,6 +659,10 @@ screencast::screencast()
      shortcutPause = new QxtGlobalShortcut( this );
      connect( shortcutPause, SIGNAL( activated() ), myUi.PauseButton, SLOT( click() ) );
      shortcutPause->setShortcut( QKeySequence( "Ctrl+Shift+F12" ) );
+
+     shortcutReplay = new QxtGlobalShortcut( this );
+     connect( shortcutReplay, SIGNAL( activated() ), this, SLOT( replaySave() ) );
+     shortcutReplay->setShortcut( QKeySequence( "Ctrl+Shift+F7" ) );
    }   
 
    myAlsaWatcher = new QvkAlsaWatcher();
@@ -532,27 +676,11 @@ screencast::screencast()
    clickedScreenSize();
    AreaOnOff();
    
-   qDebug() << "[vokoscreen] ---Begin search devices---";
-     QString device = "x11grab";
-     if ( formatsAndCodecs->isDeviceAvailable( device ) == true )
-     {
-       qDebug() << "[vokoscreen] find device" << device;
-     }
-     else
-     {
-       qDebug() << "[vokoscreen] not found device" << device;
-       QMessageBox msgBox;
-       msgBox.setText("Your ffmpeg is not compatible with vokoscreen");
-       msgBox.setInformativeText("ffmpeg must copmpiled with option --enable-x11grab");
-       msgBox.setStandardButtons( QMessageBox::Ok );
-       msgBox.setDefaultButton( QMessageBox::Ok );
-     }
-   qDebug() << "[vokoscreen] ---End search devices---";
-   qDebug( " " );
-   
    addVokoscreenExtensions();
    connect( myUi.extensionLoadpushButton, SIGNAL( clicked() ), this, SLOT( extensionLoadpushButtonClicked() ) );
    myUi.tabWidget->setCurrentIndex( vkSettings.getTab() );
+   connect( myUi.tabWidget, SIGNAL( currentChanged( int ) ), this, SLOT( tabChanged( int ) ) );
+   tabChanged( myUi.tabWidget->currentIndex() );
 
   // workDirectory setzen damit die links in about funktionieren.
   QSettings settings( vkSettings.getProgName(), vkSettings.getProgName() );
@@ -566,6 +694,8 @@ screencast::screencast()
 
 screencast::~screencast()
 { 
+  // Waits for probes that are still running
+  delete startupTasks;
 }
 
 
@@ -576,6 +706,15 @@ void screencast::closeEvent( QCloseEvent * event )
 {
   (void)event;
   Stop();
+  benchmark->stop();
+  fileMover->waitForFinished();
+  mergeJob->waitForFinished();
+  previewMergeJob->waitForFinished();
+  previewMover->waitForFinished();
+  replayBuffer->waitForFinished();
+  segmentRotator->waitForFinished();
+  recovery->waitForFinished();
+  jobQueue->stop();
   saveSettings();
   if ( myUi.pointerCheckBox->checkState() == Qt::Checked )
   {
@@ -696,6 +835,7 @@ void screencast::stateChangedshortcutsOnOff( int state )
     shortcutStart->setEnabled( true );
     shortcutStop->setEnabled( true );
     shortcutPause->setEnabled( true );
+    shortcutReplay->setEnabled( true );
   }
     
   if ( state == Qt::Unchecked )
@@ -705,6 +845,7 @@ void screencast::stateChangedshortcutsOnOff( int state )
     shortcutStart->setEnabled( false );
     shortcutStop->setEnabled( false );
     shortcutPause->setEnabled( false );
+    shortcutReplay->setEnabled( false );
   }
 }
 
@@ -946,8 +1087,15 @@ void screencast::saveSettings()
   
   settings.beginGroup( "Miscellaneous" );
     settings.setValue( "VideoPath", myUi.SaveVideoPathLineEdit->displayText() );
-    settings.setValue( "Videoplayer", myUi.VideoplayerComboBox->currentText() );
-    settings.setValue( "GIFplayer", myUi.GIFplayerComboBox->currentText() );
+    // Not searched yet, the player from the settings is kept
+    if ( startupTasks->isFinished( "Videoplayer" ) == true )
+      settings.setValue( "Videoplayer", myUi.VideoplayerComboBox->currentText() );
+    else
+      settings.setValue( "Videoplayer", vkSettings.getVideoPlayer() );
+    if ( startupTasks->isFinished( "GIFplayer" ) == true )
+      settings.setValue( "GIFplayer", myUi.GIFplayerComboBox->currentText() );
+    else
+      settings.setValue( "GIFplayer", vkSettings.getGIFPlayer() );
     settings.setValue( "Minimized", myUi.MinimizedCheckBox->checkState() );
     settings.setValue( "MinimizedByStart", myUi.MinimizedByStartCheckBox->checkState() );
     settings.setValue( "Countdown", myUi.CountdownSpinBox->value() );
@@ -963,6 +1111,24 @@ void screencast::saveSettings()
     settings.setValue( "Audiocodec", myUi.AudiocodecComboBox->currentText() );
     settings.setValue( "Format", myUi.VideoContainerComboBox->currentText() );
     settings.setValue( "HideMouse", myUi.HideMouseCheckbox->checkState() );    
+    settings.setValue( "NativeCapture", myUi.NativeCaptureCheckBox->checkState() );
+    settings.setValue( "VariableFrameRate", myUi.VariableFrameRateCheckBox->checkState() );
+    settings.setValue( "Threading", myUi.ThreadingComboBox->currentIndex() );
+    settings.setValue( "ReservedCores", myUi.ReservedCoresSpinBox->value() );
+    settings.setValue( "Adaptive", myUi.AdaptiveCheckBox->checkState() );
+    settings.setValue( "Replay", myUi.ReplayCheckBox->checkState() );
+    settings.setValue( "ReplaySeconds", myUi.ReplaySpinBox->value() );
+    settings.setValue( "Segment", myUi.SegmentCheckBox->checkState() );
+    settings.setValue( "SegmentMinutes", myUi.SegmentMinutesSpinBox->value() );
+    settings.setValue( "SegmentSize", myUi.SegmentSizeSpinBox->value() );
+    settings.setValue( "Preview", myUi.PreviewCheckBox->checkState() );
+    settings.setValue( "PreviewHeight", myUi.PreviewSpinBox->value() );
+    settings.setValue( "Transcode", myUi.TranscodeCheckBox->checkState() );
+    settings.setValue( "TranscodeProfile", myUi.TranscodeComboBox->currentText() );
+    settings.setValue( "FollowCursor", myUi.FollowCursorCheckBox->checkState() );
+    settings.setValue( "ScreenStreams", myUi.ScreenStreamsCheckBox->checkState() );
+    settings.setValue( "ScreenStreamsMode", myUi.ScreenStreamsComboBox->currentIndex() );
+    settings.setValue( "ScalePercent", myUi.ScaleComboBox->currentData().toInt() );
   settings.endGroup();
   
   settings.beginGroup( "GUI" );
@@ -1120,30 +1286,89 @@ void screencast::searchExternalPrograms()
   qDebug() << "[vokoscreen]" << "---Begin Search external tools---";
   
   if ( searchProgramm( vkSettings.getRecorder() ) )
-     qDebug() << "[vokoscreen]" << "Search ffmpeg     ..... found" << vkSettings.getRecorder() << "Version:" << getFfmpegVersion();
+     qDebug() << "[vokoscreen]" << "Search ffmpeg     ..... found" << vkSettings.getRecorder();
   else
      qDebug() << "[vokoscreen]" << "Search ffmpeg     ..... not found. Please install ffmpeg";
 
-  if ( searchProgramm("pactl") )
-     qDebug() << "[vokoscreen]" << "Search pactl      ..... found Version:" << getPactlVersion();
-  else
-     qDebug() << "[vokoscreen]" << "Search pactl      ..... pactl not found, this is an pulseaudio-utils tool. Please install pulseaudio-utils";
+  // The tools are asked at the same time in the thread pool, the result comes in startupTaskFinished.
+  // The players are only needed for the tab Miscellaneous and for play, they are searched then.
+  startupTasks->add( "pactl", [] () -> QVariant
+  {
+    if ( searchProgramm( "pactl" ) )
+      return getPactlVersion();
+    return QVariant();
+  } );
 
-  if ( searchProgramm("xdg-email") )
-     qDebug() << "[vokoscreen]" << "Search xdg-email  ..... found Version:" << getXdgemailVersion();
-  else
-     qDebug() << "[vokoscreen]" << "Search xdg-email  ..... xdg-email not found, this is an xdg-utils tool. Please install xdg-utils";
+  startupTasks->add( "xdg-email", [] () -> QVariant
+  {
+    if ( searchProgramm( "xdg-email" ) )
+      return getXdgemailVersion();
+    return QVariant();
+  } );
 
-  if ( searchProgramm("lsof") )
-     qDebug() << "[vokoscreen]" << "Search lsof       ..... found Version:" << getLsofVersion();
-  else
-     qDebug() << "[vokoscreen]" << "Search lsof       ..... lsof not found. Please install lsof";
+  startupTasks->add( "lsof", [] () -> QVariant
+  {
+    if ( searchProgramm( "lsof" ) )
+      return getLsofVersion();
+    return QVariant();
+  } );
+
+  startupTasks->addLazy( "Videoplayer", &screencast::searchVideoPlayer );
+  startupTasks->addLazy( "GIFplayer", &screencast::searchGIFPlayer );
   
   qDebug() << "[vokoscreen]" << "---End search external tools---";
   qDebug( " " );
 }
 
 
+void screencast::startupTaskFinished( QString name, QVariant result )
+{
+  if ( name == "pactl" )
+  {
+    if ( result.isNull() == false )
+       qDebug() << "[vokoscreen]" << "Search pactl      ..... found Version:" << result.toString();
+    else
+       qDebug() << "[vokoscreen]" << "Search pactl      ..... pactl not found, this is an pulseaudio-utils tool. Please install pulseaudio-utils";
+  }
+
+  if ( name == "xdg-email" )
+  {
+    if ( result.isNull() == false )
+       qDebug() << "[vokoscreen]" << "Search xdg-email  ..... found Version:" << result.toString();
+    else
+       qDebug() << "[vokoscreen]" << "Search xdg-email  ..... xdg-email not found, this is an xdg-utils tool. Please install xdg-utils";
+    myUi.sendPushButton->setEnabled( result.isNull() == false );
+  }
+
+  if ( name == "lsof" )
+  {
+    if ( result.isNull() == false )
+       qDebug() << "[vokoscreen]" << "Search lsof       ..... found Version:" << result.toString();
+    else
+       qDebug() << "[vokoscreen]" << "Search lsof       ..... lsof not found. Please install lsof";
+  }
+
+  if ( name == "Videoplayer" )
+    setVideoPlayer( result.toList() );
+
+  if ( name == "GIFplayer" )
+    setGIFPlayer( result.toList() );
+}
+
+
+/**
+ * The players are shown in the tab Miscellaneous
+ */
+void screencast::tabChanged( int index )
+{
+  if ( myUi.tabWidget->widget( index ) == myUi.tab_2 )
+  {
+    startupTasks->request( "Videoplayer" );
+    startupTasks->request( "GIFplayer" );
+  }
+}
+
+
 /**
  * Search program foo in PATH
  */
@@ -1171,21 +1396,12 @@ bool screencast::searchProgramm( QString ProgName )
 }
 
 
+/**
+ * First line of "ffmpeg -version", empty as long as the recorder is probed
+ */
 QString screencast::getFfmpegVersion()
 {
-  QProcess Process;
-  Process.start(vkSettings.getRecorder(), QStringList("-version"));
-  Process.waitForFinished();
-  QString ffmpegversion = Process.readAllStandardOutput();
-  Process.close();
-  
-  QStringList list = ffmpegversion.split( "\n" );
-  if ( list.empty() )
-    ffmpegversion = "";
-  else
-    ffmpegversion = list[ 0 ];
-
-  return ffmpegversion;
+  return formatsAndCodecs->getVersion();
 }
 
 /*
@@ -1427,55 +1643,54 @@ void screencast::PulseMultipleChoice()
   qDebug( " " );
 }
 
-#include <X11/Xlib.h>
-void screencast::windowMove()
+/**
+ * x11grab records a fixed rectangle, the ffmpeg process is stopped while the window is moved
+ */
+void screencast::windowMoveStarted()
 {
-  Window root_return, child_return;
-  int root_x_return, root_y_return;
-  int win_x_return, win_y_return;
-  unsigned int mask_return;
-  XQueryPointer( QX11Info::display(), moveWindowID, &root_return, &child_return, &root_x_return, &root_y_return, 
-                                          &win_x_return, &win_y_return, &mask_return );
-
-  if ( ( root_y_return < QxtWindowSystem::windowGeometryWithoutFrame( moveWindowID ).y() ) )
+  if ( SystemCall->state() == QProcess::Running )
   {
-    if ( SystemCall->state() == QProcess::Running )
-    {
-      if ( ( QxtWindowSystem::activeWindow() == moveWindowID ) and ( mask_return == 272 ) )
-      {
-        SystemCall->terminate();
-        SystemCall->waitForFinished();
-        pause = true;
-        QvkPulse::pulseUnloadModule();
-        return;
-      }
-    }
+    stopRecorder();
+    pause = true;
+    windowMovePaused = true;
+    QvkPulse::pulseUnloadModule();
   }
-  
-  // Window have new position
-  if ( ( pause == true ) and ( SystemCall->state() == QProcess::NotRunning ) )
+}
+
+
+/**
+ * The native capture engine follows the window, it is not paused while the window is moved
+ */
+void screencast::windowMoved()
+{
+  if ( captureController->isRunning() and ( captureController->isPaused() == false ) )
   {
-    if ( ( QxtWindowSystem::activeWindow() == moveWindowID ) and ( mask_return == 16 ) )
-    {
-      newMovedXYcoordinates();
-      myUi.PauseButton->setChecked( false );  
-      myUi.PauseButton->setText( tr ( "Pause" ) );
-      startRecord((PathTempLocation() + QDir::separator() + newPauseNameInTmpLocation()), deltaXMove, deltaYMove);
-      return;
-    }
+    newMovedXYcoordinates();
+    captureController->setCaptureOrigin( deltaXMove.toInt(), deltaYMove.toInt() );
   }
-  
-  // Window is closed
-  QStringList stringList;
-  QList<WId> list = QxtWindowSystem::windows() ;
-  for( int i = 0; i < list.count(); i++)
-    stringList << QString::number( list[ i ] );
+}
+
 
-  if ( !stringList.contains( QString::number( moveWindowID ) ) )
+/**
+ * Window have new position, a new fragment begins there
+ */
+void screencast::windowMoveFinished()
+{
+  if ( ( windowMovePaused == true ) and ( pause == true ) and ( isRecorderRunning() == false ) )
   {
-    windowMoveTimer->stop();
-    Stop();
-  } 
+    windowMovePaused = false;
+    newMovedXYcoordinates();
+    myUi.PauseButton->setChecked( false );
+    myUi.PauseButton->setText( tr ( "Pause" ) );
+    startRecord((PathTempLocation() + QDir::separator() + newPauseNameInTmpLocation()), deltaXMove, deltaYMove);
+  }
+}
+
+
+void screencast::windowClosed()
+{
+  windowMovePaused = false;
+  Stop();
 }
 
 void screencast::newMovedXYcoordinates()
@@ -1653,7 +1868,7 @@ void screencast::clickedScreenSize()
 {
   if ( myUi.FullScreenRadioButton->isChecked() )
   {
-    if ( SystemCall->state() == QProcess::Running )
+    if ( isRecorderRunning() )
     {
       statusbarLabelScreenSize->setText( "F:" + getRecordWidth() + "x" + getRecordHeight() );
     }
@@ -1662,7 +1877,7 @@ void screencast::clickedScreenSize()
       statusbarLabelScreenSize->setText( "F" );
     }
     
-    if ( ( SystemCall->state() == QProcess::Running ) or ( myUi.PauseButton->isChecked() ) )
+    if ( isRecorderRunning() or ( myUi.PauseButton->isChecked() ) )
     {
       myUi.ScreenComboBox->setEnabled( false );
     }
@@ -1677,7 +1892,7 @@ void screencast::clickedScreenSize()
   
   if ( myUi.WindowRadioButton->isChecked() )
   {
-    if ( SystemCall->state() == QProcess::Running )
+    if ( isRecorderRunning() )
     {
       statusbarLabelScreenSize->setText( "W:" + getRecordWidth() + "x" + getRecordHeight() );
     }
@@ -1697,7 +1912,7 @@ void screencast::clickedScreenSize()
   
   if ( myUi.AreaRadioButton->isChecked() )
   {
-    if ( SystemCall->state() == QProcess::Running )
+    if ( isRecorderRunning() )
     {
       statusbarLabelScreenSize->setText( "A:" + getRecordWidth() + "x" + getRecordHeight() );
     }
@@ -1746,7 +1961,10 @@ void screencast::setFrameStandardSpinbox()
 }
 
 
-void screencast::searchGIFPlayer()
+/**
+ * Runs in the thread pool, gives a list of name and command
+ */
+QVariant screencast::searchGIFPlayer()
 {
     qDebug() << "[vokoscreen]" << "---Begin search GIFplayer---";
     QStringList GIFList = QStringList()  << "firefox"
@@ -1754,25 +1972,45 @@ void screencast::searchGIFPlayer()
                                          << "chromium"
                                          << "konqueror";
 
+    QVariantList list;
     for ( int x = 0; x < GIFList.size(); ++x )
     {
       if ( searchProgramm( GIFList[ x ] ) == true )
       {
         qDebug() << "[vokoscreen]" << "Find GIFplayer :" << GIFList[ x ];
-        myUi.GIFplayerComboBox->addItem( QIcon::fromTheme( GIFList.at( x ),
-                                         QIcon( ":/pictures/videooptionen.png" ) ),
-                                         GIFList.at( x ),
-                                         GIFList.at( x ) );
+        list << QVariant( QStringList() << GIFList.at( x ) << GIFList.at( x ) );
       }
     }
     qDebug() << "[vokoscreen]" << "---End search GIFplayer---";
     qDebug( " " );
+    return list;
 }
 
-void screencast::searchVideoPlayer()
+
+void screencast::setGIFPlayer( QVariantList list )
 {
-    myUi.VideoplayerComboBox->insertItem( -1 , QIcon( ":/pictures/videooptionen.png" ), "Standard system player" );
+    for ( int x = 0; x < list.size(); ++x )
+    {
+      QStringList player = list.at( x ).toStringList();
+      myUi.GIFplayerComboBox->addItem( QIcon::fromTheme( player.at( 0 ),
+                                       QIcon( ":/pictures/videooptionen.png" ) ),
+                                       player.at( 0 ),
+                                       player.at( 1 ) );
+    }
 
+    int x = myUi.GIFplayerComboBox->findText( vkSettings.getGIFPlayer(), Qt::MatchExactly );
+    if ( x == -1 )
+      myUi.GIFplayerComboBox->setCurrentIndex( 0 );
+    else
+      myUi.GIFplayerComboBox->setCurrentIndex( x );
+}
+
+
+/**
+ * Runs in the thread pool, gives a list of name and command
+ */
+QVariant screencast::searchVideoPlayer()
+{
     qDebug() << "[vokoscreen]" << "---Begin search Videoplayer---";
     QStringList playerList = QStringList()  << "vlc"
                                             << "kaffeine"
@@ -1792,6 +2030,7 @@ void screencast::searchVideoPlayer()
                                             << "mpv"
                                             << "audience";
 
+    QVariantList list;
     QString playerName;
     QString resultString( qgetenv( "PATH" ) );
     QStringList pathList = resultString.split( ":" );
@@ -1809,11 +2048,7 @@ void screencast::searchVideoPlayer()
            if ( playProg.fileName() == "kdenlive" )
              playerName = playerName + " -i";
 
-             myUi.VideoplayerComboBox->addItem( QIcon::fromTheme( playerList.at( x ),
-                                                QIcon( ":/pictures/videooptionen.png" ) ),
-                                                playerList.at( x ),
-                                                playerName );
-
+           list << QVariant( QStringList() << playerList.at( x ) << playerName );
            break;
          }
        }
@@ -1821,6 +2056,26 @@ void screencast::searchVideoPlayer()
           
     qDebug() << "[vokoscreen]" << "---End search Videoplayer---";
     qDebug( " " );
+    return list;
+}
+
+
+void screencast::setVideoPlayer( QVariantList list )
+{
+    for ( int x = 0; x < list.size(); ++x )
+    {
+      QStringList player = list.at( x ).toStringList();
+      myUi.VideoplayerComboBox->addItem( QIcon::fromTheme( player.at( 0 ),
+                                         QIcon( ":/pictures/videooptionen.png" ) ),
+                                         player.at( 0 ),
+                                         player.at( 1 ) );
+    }
+
+    int x = myUi.VideoplayerComboBox->findText( vkSettings.getVideoPlayer(), Qt::MatchExactly );
+    if ( x == -1 )
+      myUi.VideoplayerComboBox->setCurrentIndex( 0 );
+    else
+      myUi.VideoplayerComboBox->setCurrentIndex( x );
 }
 
 
@@ -1839,7 +2094,7 @@ void screencast::saveVideoPath()
 }
 
 
-void screencast::readyReadStandardError()
+void screencast::updateRecordTime()
 {
   int s = beginTime.secsTo( QDateTime::currentDateTime() );
   int HH = s / 3600;
@@ -1848,35 +2103,25 @@ void screencast::readyReadStandardError()
   QTime myTime( HH, MM, SS);
   QString time = myTime.toString ( "hh:mm:ss");
   statusBarLabelTime->setText( time );
+}
 
-  QString output = SystemCall->readAllStandardError();
-  if ( output.contains( "fps=", Qt::CaseInsensitive ) )
-  {
-    int x = output.indexOf( "fps" );
-    statusBarLabelFps->setText( output.mid( x + 4, 3 ).replace( " ", "" ) );
-  }
-  
-  qint64 summFileSize = 0;
-  QFileInfo fileInfo;
-  if ( pause == true )
-  {
-    QDir dir( PathTempLocation() + QDir::separator() );
-    QStringList stringList = dir.entryList(QDir::Files, QDir::Time | QDir::Reversed);
-    
-    for ( int i = 0; i < stringList.size(); ++i )
-    {
-      fileInfo.setFile( PathTempLocation() + QDir::separator() + stringList[ i ] );
-      summFileSize = summFileSize + fileInfo.size() / 1024;
-    }
-  }
-  else
-  {
-    fileInfo.setFile( PathTempLocation() + QDir::separator() + nameInMoviesLocation );
-    summFileSize = fileInfo.size() / 1024 ;
-   
-  }
 
-  statusBarLabelSize->setText( QString::number( summFileSize ) );
+void screencast::readyReadStandardError()
+{
+  // The progress comes with -progress on stdout, stderr has only messages
+  SystemCall->readAllStandardError();
+}
+
+
+void screencast::readyReadStandardOutput()
+{
+  progressParser->feed( SystemCall->readAllStandardOutput() );
+}
+
+
+void screencast::recordSizeChanged( qint64 bytes )
+{
+  statusBarLabelSize->setText( QString::number( bytes / 1024 ) );
 }
 
 
@@ -2037,6 +2282,7 @@ void screencast::stateChanged ( QProcess::ProcessState newState )
       if ( !myUi.PauseButton->isChecked() and myUi.AreaRadioButton->isChecked() )
       {
         myregionselection->lockFrame( false );
+        myregionselection->show();
       }
     }
 
@@ -2093,6 +2339,29 @@ void screencast::error( QProcess::ProcessError error )
     msgBox.setIcon( QMessageBox::Critical );
     msgBox.setText( crashedtext + day + ", " + time );
     msgBox.exec();
+
+    // The file is written in fragments, what was recorded until the crash is saved like with the stop button.
+    // A crash while Stop() ends ffmpeg is saved by Stop() itself.
+    if ( stopping == false )
+    {
+      if ( myUi.PauseButton->isChecked() )
+        myUi.PauseButton->setChecked( false );
+      Stop();
+      stateChanged( QProcess::NotRunning );
+    }
+
+    // Left overs of earlier crashes, the directories of the jobs that save this recording are not touched
+    if ( ( stopping == false ) and ( recovery->isBusy() == false ) )
+    {
+      const QString temp = PathTempLocation();
+      QStringList busyDirectories;
+      if ( fileMover->isBusy() )
+        busyDirectories << temp;
+      busyDirectories << mergeJob->getBusyDirectories();
+      busyDirectories << previewMergeJob->getBusyDirectories();
+      busyDirectories << segmentRotator->getBusyDirectories();
+      recovery->start( ffmpegProgram, temp, moviePath, busyDirectories );
+    }
   }
 
   // Noch nicht getestet
@@ -2107,15 +2376,40 @@ void screencast::error( QProcess::ProcessError error )
 
 void screencast::Pause()
 {
+  // The native capture engine pauses in the running session, no new file and no countdown
+  if ( captureController->isRunning() or screenRecorder->isRunning() )
+  {
+    pause = true;
+    if ( myUi.PauseButton->isChecked() )
+    {
+      windowWatcher->release();
+      myUi.PauseButton->setText( tr ( "Continue" ) );
+      captureController->pause();
+      screenRecorder->pause();
+    }
+    else
+    {
+      myUi.PauseButton->setText( tr( "Pause" ) );
+      if ( myUi.WindowRadioButton->isChecked() )
+      {
+        newMovedXYcoordinates();
+        captureController->setCaptureOrigin( deltaXMove.toInt(), deltaYMove.toInt() );
+        windowWatcher->watch( moveWindowID );
+      }
+      captureController->resume();
+      screenRecorder->resume();
+    }
+    return;
+  }
+
   if ( myUi.FullScreenRadioButton->isChecked() or myUi.AreaRadioButton->isChecked() )
   {
     pause = true;
     if ( myUi.PauseButton->isChecked() )
     {
-      windowMoveTimer->stop();
+      windowWatcher->release();
       myUi.PauseButton->setText( tr ( "Continue" ) );
-      SystemCall->terminate();
-      SystemCall->waitForFinished();
+      stopRecorder();
       QvkPulse::pulseUnloadModule();
     }
     else
@@ -2140,10 +2434,9 @@ void screencast::Pause()
     pause = true;
     if ( myUi.PauseButton->isChecked() )
     {
-      windowMoveTimer->stop();
+      windowWatcher->release();
       myUi.PauseButton->setText( tr ( "Continue" ) );
-      SystemCall->terminate();
-      SystemCall->waitForFinished();
+      stopRecorder();
       QvkPulse::pulseUnloadModule();
     }
     else
@@ -2160,7 +2453,7 @@ void screencast::Pause()
       myUi.PauseButton->setText( tr( "Pause" ) );
       newMovedXYcoordinates();
       startRecord( PathTempLocation() + QDir::separator() + newPauseNameInTmpLocation(), deltaXMove, deltaYMove );
-      windowMoveTimer->start();
+      windowWatcher->watch( moveWindowID );
     }
   }
 }
@@ -2174,6 +2467,9 @@ void screencast::play()
   if ( myUi.MagnifierCheckBox->isChecked() )
     myUi.MagnifierCheckBox->click();
 
+  // Waits if the players are not searched yet
+  startupTasks->result( "Videoplayer" );
+  startupTasks->result( "GIFplayer" );
 
   QDir Dira( PathMoviesLocation() );
   QStringList filters;
@@ -2307,8 +2603,44 @@ QString screencast::getFileWithPath( QString ProgName )
 void screencast::recorderLineEditTextChanged( QString recorder )
 {
    (void)recorder;
+   recorderTimer->start();
+}
+
+
+void screencast::recorderProbe()
+{
+   recorderTimer->stop();
    formatsAndCodecs->getFormatsAndCodecs( myUi.RecorderLineEdit->displayText() );
+}
+
+
+/**
+ * The tables of the recorder are there, from the cache or from the probe
+ */
+void screencast::formatsAndCodecsChanged()
+{
+   qDebug() << "[vokoscreen]" << "ffmpeg Version:" << getFfmpegVersion();
+   qDebug( " " );
+
    SearchFormats();
+
+   qDebug() << "[vokoscreen] ---Begin search devices---";
+     QString device = "x11grab";
+     if ( formatsAndCodecs->isDeviceAvailable( device ) == true )
+     {
+       qDebug() << "[vokoscreen] find device" << device;
+     }
+     else
+     {
+       qDebug() << "[vokoscreen] not found device" << device;
+       QMessageBox msgBox;
+       msgBox.setText("Your ffmpeg is not compatible with vokoscreen");
+       msgBox.setInformativeText("ffmpeg must copmpiled with option --enable-x11grab");
+       msgBox.setStandardButtons( QMessageBox::Ok );
+       msgBox.setDefaultButton( QMessageBox::Ok );
+     }
+   qDebug() << "[vokoscreen] ---End search devices---";
+   qDebug( " " );
 }
 
 
@@ -2407,6 +2739,17 @@ QString screencast::PathTempLocation()
 }
 
 
+/**
+ * The small copy is written beside the temp location, on the same filesystem
+ */
+QString screencast::PathPreviewLocation()
+{
+  QString path = PathTempLocation() + "-preview";
+  QDir().mkpath( path );
+  return path;
+}
+
+
 /**
  * Return the new screencastname
  */
@@ -2522,6 +2865,24 @@ QStringList screencast::myAcodec()
 }
 
 
+/**
+ * Each part of the file can be played, also if ffmpeg or vokoscreen crashes:
+ * mp4 and mov in fragments without a moov atom at the end, matroska and webm
+ * with a new cluster every second.
+ */
+QStringList screencast::myFragmentFlags()
+{
+  QStringList result;
+  QString container = myUi.VideoContainerComboBox->currentText();
+  if ( ( container == "mp4" ) or ( container == "mov" ) )
+    result << "-movflags" << "+frag_keyframe+empty_moov+default_base_moof" << "-frag_duration" << "1000000";
+  if ( ( container == "mkv" ) or ( container == "webm" ) )
+    result << "-cluster_time_limit" << "1000";
+
+  return result;
+}
+
+
 void screencast::preRecord()
 {
   if ( myUi.AlsaRadioButton->isChecked() and myUi.AudioOnOffCheckbox->isChecked() )
@@ -2564,7 +2925,11 @@ void screencast::Countdown()
 
 void screencast::record()
 {
+  // The jobs get no cpu and no disk while recording
+  jobQueue->setRecording( true );
   Countdown();
+  metricsHistory.clear();
+  sizeTracker->reset();
   if ( myUi.MinimizedCheckBox->checkState() == Qt::Checked )
   {
     WindowMinimized();
@@ -2588,7 +2953,7 @@ void screencast::record()
       deltaXMove = deltaX;
       deltaYMove = deltaY;
 
-      windowMoveTimer->start( 100 );
+      windowWatcher->watch( moveWindowID );
       firststartWininfo = true;
   }
 
@@ -2628,6 +2993,10 @@ void screencast::record()
     //Makes the rectangle unmovable and unresizeable (Is enabled yet again when process finished)
     myregionselection->lockFrame( true );
 
+    // The recorded area leaves the frame when it follows the mouse, the borders would be recorded
+    if ( myUi.FollowCursorCheckBox->isChecked() )
+      myregionselection->hide();
+
     qDebug() << "[vokoscreen]" << "recording area";
   }
   
@@ -2684,17 +3053,26 @@ void screencast::record()
   // framerate
   QString framerate = "-framerate " + QString().number( myUi.FrameSpinBox->value() );
 
+  // The benchmark competes with the recording for the cpu
+  if ( benchmark->isRunning() )
+    benchmark->stop();
+
+  // Preset from the benchmark, if there is one for this codec
   QString videoCodec = myUi.VideocodecComboBox->currentText();
+  QString preset = benchmark->bestPreset( videoCodec, getRecordWidth().toInt(), getRecordHeight().toInt(), myUi.FrameSpinBox->value() );
+  if ( preset > "" )
+    qDebug() << "[vokoscreen] preset from benchmark:" << videoCodec << preset;
+
   QStringList videoFlags;
   if ( videoCodec == "libx264" || videoCodec == "libx264rgb" )
   {
-    videoFlags << "-preset" << "veryfast";
+    videoFlags << "-preset" << ( preset > "" ? preset : "veryfast" );
   }
 
   // https://trac.ffmpeg.org/wiki/Encode/H.265
   if ( videoCodec == "libx265" )
   {
-    videoFlags << "-preset" << "veryfast";
+    videoFlags << "-preset" << ( preset > "" ? preset : "veryfast" );
   }
   
   if ( videoCodec == "libvpx" )
@@ -2702,6 +3080,7 @@ void screencast::record()
     videoFlags << "-quality" << "realtime"; ;
     videoFlags << "-g" << "10000";
     videoFlags << "-b:v" << "2M";
+    videoFlags << QvkBenchmark::presetArguments( videoCodec, preset );
   }
   
   
@@ -2717,10 +3096,15 @@ void screencast::record()
   
   ffmpegInputArguments.clear();
   ffmpegInputArguments << "-report";
+  ffmpegInputArguments << "-nostats" << "-progress" << "pipe:1";
   ffmpegInputArguments << "-f" << "x11grab";
   ffmpegInputArguments << "-draw_mouse" << ((myUi.HideMouseCheckbox->checkState() == Qt::Checked) ? "0" : "1");
   ffmpegInputArguments << "-framerate" << QString().number(myUi.FrameSpinBox->value());
   ffmpegInputArguments << "-video_size" << (getRecordWidth() + "x" + getRecordHeight());
+
+  // x11grab can follow the mouse too, it jumps when the mouse comes near the edge and has no easing
+  if ( myUi.AreaRadioButton->isChecked() and myUi.FollowCursorCheckBox->isChecked() )
+    ffmpegInputArguments << "-follow_mouse" << QString::number( qMin( getRecordWidth().toInt(), getRecordHeight().toInt() ) / 4 );
   
   ffmpegOutputArguments.clear();
   ffmpegOutputArguments << myAlsa();
@@ -2737,9 +3121,130 @@ void screencast::record()
   }
   ffmpegOutputArguments << myAcodec();
   ffmpegOutputArguments << "-q:v" << "1";
-  ffmpegOutputArguments << "-s" << (getRecordWidth() + "x" + getRecordHeight());
+  ffmpegOutputArguments << "-s" << ( QString::number( scaledLength( getRecordWidth().toInt() ) ) + "x" + QString::number( scaledLength( getRecordHeight().toInt() ) ) );
   ffmpegOutputArguments << "-f" << myUi.VideoContainerComboBox->itemData(myUi.VideoContainerComboBox->currentIndex()).toString();
-  ffmpegOutputArguments << "-threads" << "4";
+
+  QvkThreadPolicy threadPolicy( myUi.ThreadingComboBox->currentData().toInt(), myUi.ReservedCoresSpinBox->value() );
+  ffmpegOutputArguments << threadPolicy.codecOptions( videoCodec );
+
+  // The instant replay records into a ring of segments, nothing goes into the temp location
+  replay = false;
+  if ( myUi.ReplayCheckBox->isChecked() and ( myUi.VideoContainerComboBox->currentText() != "gif" ) )
+  {
+    replayBuffer->setDuration( myUi.ReplaySpinBox->value() );
+    replay = replayBuffer->open();
+  }
+
+  // Long recordings are split into numbered files, the finished files are saved while recording
+  segmenting = false;
+  if ( myUi.SegmentCheckBox->isChecked() and ( replay == false ) and ( myUi.VideoContainerComboBox->currentText() != "gif" )
+       and ( ( myUi.SegmentMinutesSpinBox->value() > 0 ) or ( myUi.SegmentSizeSpinBox->value() > 0 ) ) )
+  {
+    segmenting = true;
+    segmentRotator->start( ffmpegProgram, PathTempLocation(),
+                           myUi.VideoContainerComboBox->itemData( myUi.VideoContainerComboBox->currentIndex() ).toString(),
+                           moviePath + QDir::separator() + nameInMoviesLocation,
+                           myUi.SegmentMinutesSpinBox->value() * 60, (qint64)myUi.SegmentSizeSpinBox->value() * 1024 * 1024 );
+  }
+
+  // A small copy from the same capture, the capture and the color conversion are done once
+  preview = false;
+  previewArguments.clear();
+  if ( myUi.PreviewCheckBox->isChecked() and ( replay == false ) and ( segmenting == false )
+       and ( myUi.VideoContainerComboBox->currentText() != "gif" ) )
+  {
+    preview = true;
+    QString height = QString::number( qMin( myUi.PreviewSpinBox->value(), getRecordHeight().toInt() ) / 2 * 2 );
+    QString graph;
+    if ( videoCodec == "libx264rgb" )
+      graph = "[0:v]split=2[master][small];[small]scale=-2:" + height + ",format=yuv420p[preview]";
+    else
+      graph = "[0:v]format=yuv420p,split=2[master][small];[small]scale=-2:" + height + "[preview]";
+
+    QStringList audioMap;
+    if ( myAlsa().isEmpty() == false )
+      audioMap << "-map" << "1:a";
+
+    // The filter graph comes after the audio input
+    QStringList graphArguments;
+    graphArguments << "-filter_complex" << graph << "-map" << "[master]" << audioMap;
+    int index = myAlsa().count();
+    for ( int i = 0; i < graphArguments.count(); i++ )
+      ffmpegOutputArguments.insert( index + i, graphArguments[ i ] );
+
+    QString previewCodec = ( videoCodec == "libx264rgb" ) ? "libx264" : videoCodec;
+    previewArguments << "-map" << "[preview]" << audioMap;
+    previewArguments << "-c:v" << previewCodec;
+    if ( previewCodec.startsWith( "libx26" ) )
+      previewArguments << "-preset" << "veryfast" << "-crf" << "28";
+    else if ( previewCodec == "libvpx" )
+      previewArguments << "-quality" << "realtime" << "-cpu-used" << "8" << "-b:v" << "1M";
+    else
+      previewArguments << "-b:v" << "1M";
+    previewArguments << myAcodec();
+    previewArguments << threadPolicy.codecOptions( previewCodec );
+    previewArguments << "-f" << myUi.VideoContainerComboBox->itemData( myUi.VideoContainerComboBox->currentIndex() ).toString();
+
+    QDir previewDir( PathPreviewLocation() );
+    QStringList previewList = previewDir.entryList( QDir::Files );
+    for ( int i = 0; i < previewList.size(); ++i )
+      previewDir.remove( previewList[ i ] );
+  }
+
+  // The native capture engine records only video, with audio or for gif the ffmpeg process is used.
+  // The instant replay, the segments and the small copy need ffmpeg.
+  nativeCapture = false;
+  if ( myUi.NativeCaptureCheckBox->isChecked() and ( replay == false ) and ( segmenting == false ) and ( preview == false ) )
+  {
+    if ( myAlsa().isEmpty() and ( myUi.VideoContainerComboBox->currentText() != "gif" ) )
+    {
+      nativeCapture = true;
+      nativeCodecOptions.clear();
+      nativeCodecOptions << videoFlags;
+      if ( myUi.x264LosslessCheckBox->isChecked() )
+        nativeCodecOptions << "-qp" << "0";
+      nativeCodecOptions << threadPolicy.codecOptions( videoCodec );
+      nativeThreads = threadPolicy.threads( videoCodec );
+      qDebug() << "[vokoscreen] recording with native capture engine";
+    }
+    else
+    {
+      qDebug() << "[vokoscreen] native capture engine records no audio and no gif, use" << ffmpegProgram;
+    }
+  }
+
+  // All screens of the fullscreen mode, each one as its own video instead of one canvas with black filler
+  screenRects.clear();
+  screenFiles.clear();
+  if ( ( nativeCapture == true ) and myUi.ScreenStreamsCheckBox->isChecked() and myUi.FullScreenRadioButton->isChecked()
+       and ( myUi.ScreenComboBox->itemData( myUi.ScreenComboBox->currentIndex() ).toInt() == -1 ) )
+  {
+    QDesktopWidget *desk = QApplication::desktop();
+    qreal ratio = QGuiApplication::primaryScreen()->devicePixelRatio();
+    for ( int i = 0; ( desk->screenCount() > 1 ) and ( i < desk->screenCount() ); i++ )
+    {
+      QRect geometry = desk->screenGeometry( i );
+      screenRects << QRect( qRound( geometry.left() * ratio ), qRound( geometry.top() * ratio ),
+                           qRound( geometry.width() * ratio ), qRound( geometry.height() * ratio ) );
+    }
+    qDebug() << "[vokoscreen] recording" << screenRects.count() << "screens as own videos";
+  }
+
+  // Adaptive quality, the native capture engine can change only the frame rate inside the file
+  adaptive->stop();
+  if ( myUi.AdaptiveCheckBox->isChecked() and ( myUi.VideoContainerComboBox->currentText() != "gif" ) )
+  {
+    QString basePreset;
+    for ( int i = 0; i < videoFlags.count() - 1; i++ )
+      if ( ( videoFlags[ i ] == "-preset" ) or ( videoFlags[ i ] == "-cpu-used" ) )
+        basePreset = videoFlags[ i + 1 ];
+
+    adaptive->start( videoCodec, basePreset, myUi.FrameSpinBox->value(), not nativeCapture );
+
+    // Each level is a new fragment, the parameter sets must be in every keyframe for the merge
+    if ( ( nativeCapture == false ) and videoCodec.startsWith( "libx26" ) )
+      ffmpegOutputArguments << "-flags:v" << "-global_header";
+  }
 
   startRecord((PathTempLocation() + QDir::separator() + nameInMoviesLocation), deltaX, deltaY);
 }
@@ -2747,7 +3252,81 @@ void screencast::record()
 
 void screencast::startRecord(QString RecordPathName, QString x, QString y)
 {
-  
+  if ( nativeCapture == true )
+  {
+    QvkCaptureSettings captureSettings;
+    captureSettings.display = DISPLAY;
+    captureSettings.x = x.toInt();
+    captureSettings.y = y.toInt();
+    captureSettings.width = getRecordWidth().toInt();
+    captureSettings.height = getRecordHeight().toInt();
+    if ( scalePercent() < 100 )
+    {
+      captureSettings.outputWidth = scaledLength( captureSettings.width );
+      captureSettings.outputHeight = scaledLength( captureSettings.height );
+    }
+    captureSettings.frameRate = myUi.FrameSpinBox->value();
+    captureSettings.showCursor = ( myUi.HideMouseCheckbox->checkState() != Qt::Checked );
+    captureSettings.variableFrameRate = myUi.VariableFrameRateCheckBox->isChecked();
+    if ( myUi.WindowRadioButton->isChecked() )
+      captureSettings.window = moveWindowID;
+    captureSettings.followCursor = myUi.AreaRadioButton->isChecked() and myUi.FollowCursorCheckBox->isChecked();
+    captureSettings.fileName = RecordPathName;
+    captureSettings.format = myUi.VideoContainerComboBox->itemData( myUi.VideoContainerComboBox->currentIndex() ).toString();
+    captureSettings.videoCodec = myUi.VideocodecComboBox->currentText();
+    captureSettings.codecOptions = nativeCodecOptions;
+    captureSettings.threads = nativeThreads;
+
+    if ( screenRects.isEmpty() == false )
+    {
+      // The threads of the encoder are shared by the screens
+      QFileInfo fileInfo( RecordPathName );
+      QList<QvkCaptureSettings> list;
+      screenFiles.clear();
+      for ( int i = 0; i < screenRects.count(); i++ )
+      {
+        QvkCaptureSettings screenSettings = captureSettings;
+        screenSettings.x = screenRects[ i ].x();
+        screenSettings.y = screenRects[ i ].y();
+        screenSettings.width = screenRects[ i ].width() / 2 * 2;
+        screenSettings.height = screenRects[ i ].height() / 2 * 2;
+        if ( scalePercent() < 100 )
+        {
+          screenSettings.outputWidth = scaledLength( screenSettings.width );
+          screenSettings.outputHeight = scaledLength( screenSettings.height );
+        }
+        screenSettings.threads = qMax( 1, nativeThreads / screenRects.count() );
+        setArgumentValue( screenSettings.codecOptions, "-threads", QString::number( screenSettings.threads ) );
+        if ( myUi.ScreenStreamsComboBox->currentIndex() == 0 )
+        {
+          screenSettings.fileName = fileInfo.absolutePath() + QDir::separator() + fileInfo.completeBaseName()
+                                    + "-screen" + QString::number( i + 1 ) + "." + fileInfo.suffix();
+          screenFiles << QFileInfo( screenSettings.fileName ).fileName();
+        }
+        list << screenSettings;
+      }
+
+      if ( myUi.ScreenStreamsComboBox->currentIndex() == 0 )
+        screenRecorder->setTrackFile( "", "" );
+      else
+        screenRecorder->setTrackFile( RecordPathName, captureSettings.format );
+
+      beginTime = QDateTime::currentDateTime();
+      if ( screenRecorder->start( list ) == false )
+      {
+        nativeCaptureError( screenRecorder->errorString() );
+      }
+      return;
+    }
+
+    beginTime = QDateTime::currentDateTime();
+    if ( captureController->start( captureSettings ) == false )
+    {
+      nativeCaptureError( captureController->errorString() );
+    }
+    return;
+  }
+
   if ( myUi.PulseDeviceRadioButton->isChecked() )
   {
     QProcess Process;
@@ -2799,74 +3378,439 @@ void screencast::startRecord(QString RecordPathName, QString x, QString y)
   QStringList arguments;
   arguments << ffmpegInputArguments;
   arguments << "-i" << (DISPLAY + "+" + x + "," + y);
-  arguments << ffmpegOutputArguments;
-  arguments << RecordPathName;
+  if ( ( replay == true ) or ( segmenting == true ) )
+  {
+    // The container is given by the segment muxer
+    QStringList outputArguments = ffmpegOutputArguments;
+    int index = outputArguments.lastIndexOf( "-f" );
+    if ( index >= 0 )
+    {
+      outputArguments.removeAt( index );
+      outputArguments.removeAt( index );
+    }
+    arguments << outputArguments;
+    if ( replay == true )
+      arguments << replayBuffer->segmentArguments();
+    else
+      arguments << segmentRotator->chunkArguments();
+  }
+  else
+  {
+    arguments << ffmpegOutputArguments;
+    arguments << myFragmentFlags();
+    arguments << RecordPathName;
+    if ( preview == true )
+    {
+      arguments << previewArguments;
+      arguments << myFragmentFlags();
+      arguments << PathPreviewLocation() + QDir::separator() + QFileInfo( RecordPathName ).fileName();
+    }
+  }
 
   debugCommandInvocation("Executing command", ffmpegProgram, arguments);
   qDebug( " " );
 
+  progressParser->reset();
+  // The segment muxer writes chunks, RecordPathName is not written then
+  if ( replay == true )
+    sizeTracker->startSegment( replayBuffer->directory() );
+  else if ( segmenting == true )
+    sizeTracker->startSegment( PathTempLocation() );
+  else
+    sizeTracker->startSegment( RecordPathName );
   SystemCall->start(ffmpegProgram, arguments);
 
   beginTime  = QDateTime::currentDateTime();
 }
 
 
-void screencast::Stop()
+/**
+ * Replaces the value after key, nothing happens if the key is not in the list.
+ */
+void screencast::setArgumentValue( QStringList &list, QString key, QString value )
 {
-    if ( SystemCall->state() == QProcess::Running )
-    {
-        SystemCall->terminate();
-        SystemCall->waitForFinished( 3000 );
-    }
+  int index = list.indexOf( key );
+  if ( ( index >= 0 ) and ( index + 1 < list.count() ) )
+    list[ index + 1 ] = value;
+}
 
-    if ( ( pause == true ) and (  myUi.VideocodecComboBox->currentText() != "gif" ) )
-    {
-        QDir dir( PathTempLocation() );
-        QStringList stringList = dir.entryList(QDir::Files, QDir::Time | QDir::Reversed);
-        QString mergeFile = QStandardPaths::writableLocation( QStandardPaths::TempLocation ) + QDir::separator() + "mergeFile.txt";
-        QFile file( mergeFile );
-        file.open( QIODevice::WriteOnly | QIODevice::Text );
-        QString videoFiles;
-        for ( int i = 0; i < stringList.size(); ++i )
-        {
-            QString filepath = PathTempLocation() + QDir::separator() + stringList[i];
-            videoFiles.append( "file " ).append("'" + filepath.replace("'", "\\'") + "'").append( "\n" );
-            file.write( videoFiles.toLatin1() );
-            videoFiles = "";
-        }
-        file.close();
 
-        QStringList mergeArguments;
-        mergeArguments << "-report";
-        mergeArguments << "-safe" << "0";
-        mergeArguments << "-f" << "concat";
-        mergeArguments << "-i" << mergeFile;
-        mergeArguments << "-c" << "copy";
-        mergeArguments << (moviePath + QDir::separator() + nameInMoviesLocation);
-        SystemCall->start(ffmpegProgram, mergeArguments);
-        SystemCall->waitForFinished(8000);
+/**
+ * The size of the video in percent of the recorded size,
+ * the logical size of a HiDPI screen is the size without the device pixel ratio.
+ */
+int screencast::scalePercent()
+{
+  int value = myUi.ScaleComboBox->currentData().toInt();
+  if ( value == 0 )
+    value = qRound( 100 / QGuiApplication::primaryScreen()->devicePixelRatio() );
+  return qBound( 1, value, 100 );
+}
+
+
+/**
+ * Even, as the encoders need it
+ */
+int screencast::scaledLength( int value )
+{
+  return value * scalePercent() / 100 / 2 * 2;
+}
+
+
+bool screencast::isRecorderRunning()
+{
+  return ( SystemCall->state() == QProcess::Running ) or captureController->isRunning() or screenRecorder->isRunning();
+}
+
+
+void screencast::stopRecorder()
+{
+  if ( captureController->isRunning() )
+  {
+    captureController->stop();
+  }
+
+  if ( screenRecorder->isRunning() )
+  {
+    screenRecorder->stop();
+  }
+
+  if ( SystemCall->state() == QProcess::Running )
+  {
+    SystemCall->terminate();
+    SystemCall->waitForFinished( 3000 );
+  }
+
+  // The segment is complete, its size is taken once
+  sizeTracker->finishSegment();
+}
+
+
+void screencast::nativeCaptureStarted()
+{
+  stateChanged( QProcess::Running );
+}
+
+
+void screencast::nativeCaptureStopped()
+{
+  stateChanged( QProcess::NotRunning );
+}
+
+
+void screencast::nativeCapturePaused()
+{
+  nativePauseTime = QDateTime::currentDateTime();
+  stateChanged( QProcess::NotRunning );
+}
+
+
+/**
+ * The recording time in the statusbar does not count the pause
+ */
+void screencast::nativeCaptureResumed()
+{
+  beginTime = beginTime.addMSecs( nativePauseTime.msecsTo( QDateTime::currentDateTime() ) );
+  stateChanged( QProcess::Running );
+}
+
+
+/**
+ * A screen with an error has stopped, the others are stopped too
+ */
+void screencast::screenStreamStopped( int session, QString error )
+{
+  if ( error.isEmpty() )
+    return;
+
+  qDebug().noquote() << "[vokoscreen] screen" << session + 1 << "has stopped";
+  if ( screenRecorder->isRunning() )
+    screenRecorder->stop();
+  nativeCaptureError( error );
+}
+
+
+void screencast::nativeCaptureError( QString value )
+{
+  qDebug().noquote() << "[vokoscreen] native capture engine:" << value;
+  QMessageBox msgBox;
+  msgBox.setIcon( QMessageBox::Critical );
+  msgBox.setText( "The native capture engine has stopped with an error" );
+  msgBox.setInformativeText( value );
+  msgBox.exec();
+}
+
+
+/**
+ * Reports of ffmpeg -progress and of the native capture engine
+ */
+void screencast::encoderMetrics( QvkEncoderMetrics value )
+{
+  metricsHistory.append( value );
+  updateRecordTime();
+
+  adaptive->update( value );
+
+  statusBarLabelFps->setText( QString::number( qRound( value.fps ) ) );
+  statusBarLabelSpeed->setText( QString::number( value.speed, 'f', 2 ) + "x" );
+  statusBarLabelDrop->setText( QString::number( value.dropFrames ) + "/" + QString::number( value.dupFrames ) );
+  statusBarLabelSize->setToolTip( tr( "Size in KB" ) + ", " + QString::number( qRound( value.bitrate ) ) + " kbit/s" );
+  // The size of the process recorder comes from sizeTracker
+  if ( captureController->isRunning() or screenRecorder->isRunning() )
+    statusBarLabelSize->setText( QString::number( value.totalSize / 1024 ) );
+
+  // A single slow report is no problem, e.g. while a window is opened
+  if ( ( metricsHistory.count() >= 5 ) and ( metricsHistory.averageSpeed( 5 ) < 0.95 ) )
+    statusBarLabelSpeed->setStyleSheet( "QLabel { color: red }" );
+  else
+    statusBarLabelSpeed->setStyleSheet( "" );
+}
+
+
+/**
+ * The native capture engine changes the frame rate in the running file.
+ * ffmpeg is restarted with the new level into a new fragment, Stop() merges the fragments.
+ */
+void screencast::adaptiveLevelChanged()
+{
+  if ( captureController->isRunning() )
+  {
+    captureController->setFrameRate( adaptive->frameRate() );
+    return;
+  }
+
+  if ( screenRecorder->isRunning() )
+  {
+    screenRecorder->setFrameRate( adaptive->frameRate() );
+    return;
+  }
+
+  if ( SystemCall->state() != QProcess::Running )
+    return;
+
+  // The size stays, the fragments are joined with stream copy
+  setArgumentValue( ffmpegInputArguments, "-framerate", QString::number( adaptive->frameRate() ) );
+  setArgumentValue( ffmpegOutputArguments, "-preset", adaptive->preset() );
+  setArgumentValue( ffmpegOutputArguments, "-cpu-used", adaptive->preset() );
+
+  // The widgets must not show a stopped recording while ffmpeg is restarted
+  QDateTime time = beginTime;
+  pause = true;
+  SystemCall->blockSignals( true );
+  stopRecorder();
+  SystemCall->blockSignals( false );
+  QvkPulse::pulseUnloadModule();
+  if ( myUi.WindowRadioButton->isChecked() )
+  {
+    newMovedXYcoordinates();
+    startRecord( PathTempLocation() + QDir::separator() + newPauseNameInTmpLocation(), deltaXMove, deltaYMove );
+  }
+  else
+  {
+    startRecord( PathTempLocation() + QDir::separator() + newPauseNameInTmpLocation(), deltaX, deltaY );
+  }
+  beginTime = time;
+}
+
+
+/**
+ * CTRL+SHIFT+F7, the last seconds of the instant replay are saved in the movie location
+ */
+void screencast::replaySave()
+{
+  if ( replay == false )
+    return;
+
+  QString destination = PathMoviesLocation() + QDir::separator() + "vokoscreen-replay-"
+                        + QDateTime::currentDateTime().toString( "yyyy-MM-dd_hh-mm-ss" ) + ".mkv";
+  if ( replayBuffer->save( ffmpegProgram, destination ) == true )
+    myUi.statusBar->showMessage( tr( "Saving instant replay" ) );
+}
+
+
+void screencast::replaySaved( QString destination, bool success )
+{
+  if ( success == true )
+    myUi.statusBar->showMessage( tr( "Instant replay saved" ) + ": " + destination, 10000 );
+  else
+    myUi.statusBar->showMessage( tr( "Instant replay could not be saved" ), 10000 );
+}
+
+
+void screencast::recoveryFinished( QString destination, bool success )
+{
+  if ( success == true )
+    myUi.statusBar->showMessage( tr( "A recording that was not saved has been recovered" ) + ": " + destination, 10000 );
+  else
+    qDebug().noquote() << "[vokoscreen] [recovery] can not recover" << destination;
+}
+
 
-        for ( int i = 0; i < stringList.size(); ++i )
-            dir.remove( PathTempLocation().append( QDir::separator() ).append( stringList.at( i ) ) );
+void screencast::jobsChanged()
+{
+  myUi.JobsLabel->setText( jobQueue->summary() );
+  myUi.JobsLabel->setToolTip( jobQueue->list().join( "\n" ) );
+  myUi.JobsClearPushButton->setEnabled( jobQueue->count() > 0 );
+}
+
+
+void screencast::finalizeProgress( int percent, qint64 bytes )
+{
+  vkDbus->setFinalizeProgress( percent );
+  myUi.statusBar->showMessage( tr( "Saving video" ) + " " + QString::number( percent ) + " % "
+                               + QString::number( bytes / 1024 / 1024 ) + " MB" );
+}
+
+
+void screencast::benchmarkClicked()
+{
+  if ( benchmark->isRunning() )
+  {
+    benchmark->stop();
+    return;
+  }
+
+  QStringList codecs;
+  for ( int i = 0; i < myUi.VideocodecComboBox->count(); i++ )
+    codecs << myUi.VideocodecComboBox->itemText( i );
+
+  // The whole screen, the result is scaled to smaller areas
+  QRect screen = QApplication::desktop()->screenGeometry();
+  QvkThreadPolicy threadPolicy( myUi.ThreadingComboBox->currentData().toInt(), myUi.ReservedCoresSpinBox->value() );
+
+  myUi.BenchmarkPushButton->setText( tr( "Stop benchmark" ) );
+  myUi.recordButton->setEnabled( false );
+  benchmark->start( myUi.RecorderLineEdit->displayText(), codecs, screen.width(), screen.height(), myUi.FrameSpinBox->value(), threadPolicy );
+}
 
-        file.remove();
 
-        debugCommandInvocation("Mergestring", ffmpegProgram, mergeArguments);
+void screencast::benchmarkProgress( QString codec, QString preset, int step, int steps )
+{
+  myUi.statusBar->showMessage( tr( "Benchmark" ) + " " + QString::number( step ) + "/" + QString::number( steps ) + ": "
+                               + codec + " " + preset );
+}
+
+
+void screencast::benchmarkFinished()
+{
+  myUi.statusBar->clearMessage();
+  myUi.BenchmarkPushButton->setText( tr( "Benchmark" ) );
+  if ( isRecorderRunning() == false )
+    myUi.recordButton->setEnabled( true );
+
+  QString codec = myUi.VideocodecComboBox->currentText();
+  QString preset = benchmark->bestPreset( codec, getRecordWidth().toInt(), getRecordHeight().toInt(), myUi.FrameSpinBox->value() );
+  if ( preset > "" )
+    myUi.statusBar->showMessage( tr( "Benchmark finished" ) + ", " + codec + ": " + preset, 10000 );
+}
+
+
+void screencast::benchmarkError( QString message )
+{
+  myUi.statusBar->showMessage( message, 10000 );
+}
+
+
+void screencast::finalizeFinished( QString fileName, bool success )
+{
+  vkDbus->setFinalizeProgress( -1 );
+  myUi.statusBar->clearMessage();
+
+  // The small copy is not compressed again
+  if ( ( success == true ) and myUi.TranscodeCheckBox->isChecked() and ( sender() != previewMergeJob ) and ( sender() != previewMover ) )
+    jobQueue->add( myUi.RecorderLineEdit->displayText(), fileName, myUi.TranscodeComboBox->currentText() );
+
+  // The temp directory is empty now
+  QDir dir;
+  dir.rmdir( PathTempLocation() );
+  if ( ( success == true ) and ( sender() == previewMover ) )
+    dir.rmdir( QFileInfo( previewMover->getSource() ).path() );
+
+  if ( success == false )
+  {
+    // Where the job has left the recording
+    QString keptIn = PathTempLocation();
+    if ( ( sender() == mergeJob ) or ( sender() == previewMergeJob ) )
+      keptIn = ( (QvkMergeJob*)sender() )->getWorkDirectory();
+    if ( sender() == segmentRotator )
+      keptIn = segmentRotator->getWorkDirectory();
+    if ( sender() == fileMover )
+      keptIn = fileMover->getSource();
+    if ( sender() == previewMover )
+      keptIn = previewMover->getSource();
+
+    QMessageBox msgBox;
+    msgBox.setIcon( QMessageBox::Critical );
+    msgBox.setText( tr( "The video could not be saved" ) );
+    msgBox.setInformativeText( fileName + "\n" + tr( "The recording is kept in" ) + " " + keptIn );
+    msgBox.exec();
+  }
+}
+
+
+void screencast::Stop()
+{
+    stopping = true;
+    adaptive->stop();
+    stopRecorder();
+
+    // The instant replay is only kept with the shortcut, the ring is thrown away
+    if ( replay == true )
+    {
+        replayBuffer->close();
+        replay = false;
+    }
+    // The last segment, the others are saved already
+    else if ( segmenting == true )
+    {
+        segmentRotator->stop();
+        segmenting = false;
+    }
+    // With the native capture engine a paused recording is still one file
+    else if ( ( pause == true ) and ( nativeCapture == false ) and (  myUi.VideocodecComboBox->currentText() != "gif" ) )
+    {
+        // The merge runs in its own process, the fragments are removed when it was successful
+        mergeJob->start( ffmpegProgram, PathTempLocation(), moviePath + QDir::separator() + nameInMoviesLocation );
     }
     else
     {
+        // A rename if the movie path is on the same filesystem, otherwise a copy in the background
         QString FileInTemp = PathTempLocation() + QDir::separator() + nameInMoviesLocation;
-        QFile::copy ( FileInTemp, moviePath + QDir::separator() + nameInMoviesLocation );
-        QFile::remove ( FileInTemp );
+        if ( QFile::exists( FileInTemp ) )
+            fileMover->move( FileInTemp, moviePath + QDir::separator() + nameInMoviesLocation );
+
+        // Every screen in its own file
+        for ( int i = 0; i < screenFiles.count(); i++ )
+            fileMover->move( PathTempLocation() + QDir::separator() + screenFiles[ i ], moviePath + QDir::separator() + screenFiles[ i ] );
+        screenFiles.clear();
+    }
+
+    // The small copy has the same fragments as the recording
+    if ( preview == true )
+    {
+        QFileInfo fileInfo( nameInMoviesLocation );
+        QString previewName = moviePath + QDir::separator() + fileInfo.completeBaseName() + "-small." + fileInfo.suffix();
+        if ( pause == true )
+        {
+            previewMergeJob->start( ffmpegProgram, PathPreviewLocation(), previewName );
+        }
+        else
+        {
+            // A rename, or a copy if the movie path is on an other filesystem, the directory is removed in finalizeFinished
+            previewMover->move( PathPreviewLocation() + QDir::separator() + nameInMoviesLocation, previewName );
+        }
+        preview = false;
     }
 
     QDir dir_1;
     dir_1.rmdir( PathTempLocation() );
 
     pause = false;
-    windowMoveTimer->stop();
+    windowWatcher->release();
+    windowMovePaused = false;
     firststartWininfo = false;
+    jobQueue->setRecording( false );
 
     QvkPulse::pulseUnloadModule();
-
+    stopping = false;
 }
@@ -33,6 +33,7 @@
 #include <QDate>
 #include <QStatusBar>
 #include <QDesktopWidget>
+#include <QTimer>
 #include <QDial>
 #include <QAction>
 #include <QTest>
@@ -59,6 +60,23 @@
 #include "QvkShowClickDialog.h"
 
 #include "QvkFormatsAndCodecs.h"
+#include "QvkStartupTasks.h"
+#include "QvkCaptureController.h"
+#include "QvkFileMover.h"
+#include "QvkMergeJob.h"
+#include "QvkSegmentRotator.h"
+#include "QvkProgressParser.h"
+#include "QvkMetricsHistory.h"
+#include "QvkSizeTracker.h"
+#include "QvkThreadPolicy.h"
+#include "QvkBenchmark.h"
+#include "QvkAdaptiveController.h"
+#include "QvkReplayBuffer.h"
+#include "QvkRecovery.h"
+#include "QvkJobQueue.h"
+#include "QvkWindowWatcher.h"
+#include "QvkMultiSessionRecorder.h"
+#include "QvkDbus.h"
 
 
 #include "ui_vokoscreen.h"
@@ -108,11 +126,8 @@ private slots:
   void showMagnifier();
   void uncheckMagnifier();
   void searchExternalPrograms();
-  bool searchProgramm( QString ProgName );
   QString getFfmpegVersion();
-  QString getPactlVersion();
-  QString getXdgemailVersion();
-  QString getLsofVersion();  
+  void startupTaskFinished( QString name, QVariant result );
   void AudioOff( int state );
   void AlsaWatcherEvent( QStringList CardxList );
   void PulseMultipleChoice();
@@ -139,7 +154,10 @@ private slots:
   void currentIndexChangedCodec( int index );
   void currentIndexChangedFormat( int index );
   
-  void windowMove();
+  void windowMoveStarted();
+  void windowMoved();
+  void windowMoveFinished();
+  void windowClosed();
   void newMovedXYcoordinates();
 
   // Tab Videooptionen
@@ -147,8 +165,9 @@ private slots:
   void setVideocodecStandardComboBox();
   void setAudiocodecStandardComboBox();
 
-  void searchGIFPlayer();
-  void searchVideoPlayer();
+  void setGIFPlayer( QVariantList list );
+  void setVideoPlayer( QVariantList list );
+  void tabChanged( int index );
   
   void currentFormatChanged( const QString value );
   
@@ -158,6 +177,8 @@ private slots:
   void myVideoFileSystemWatcher( const QString & path );
   QString getFileWithPath( QString ProgName );
   void recorderLineEditTextChanged( QString recorder );
+  void recorderProbe();
+  void formatsAndCodecsChanged();
   void selectRecorder();
   void showCredits();
   void creditsCloseEvent();
@@ -169,15 +190,22 @@ private slots:
 
   
   QString PathTempLocation();
+  QString PathPreviewLocation();
   QString NameInMoviesLocation();
   QString newPauseNameInTmpLocation();
   QStringList myAlsa();
   QStringList myAcodec();
+  QStringList myFragmentFlags();
   void AreaOnOff();
   void preRecord();
   void Countdown();
   void record();
   void startRecord(QString RecordPathName, QString x, QString Y);
+  void setArgumentValue( QStringList &list, QString key, QString value );
+  int scalePercent();
+  int scaledLength( int value );
+  bool isRecorderRunning();
+  void stopRecorder();
   void Stop();
   void Pause();
   void play();
@@ -186,6 +214,28 @@ private slots:
   void error ( QProcess::ProcessError error );
   void readyReadStandardError();
   void stateChanged( QProcess::ProcessState newState );
+  void updateRecordTime();
+  void recordSizeChanged( qint64 bytes );
+
+  void nativeCaptureStarted();
+  void nativeCaptureStopped();
+  void nativeCapturePaused();
+  void nativeCaptureResumed();
+  void nativeCaptureError( QString value );
+  void screenStreamStopped( int session, QString error );
+  void readyReadStandardOutput();
+  void encoderMetrics( QvkEncoderMetrics value );
+  void finalizeProgress( int percent, qint64 bytes );
+  void benchmarkClicked();
+  void benchmarkProgress( QString codec, QString preset, int step, int steps );
+  void benchmarkFinished();
+  void benchmarkError( QString message );
+  void adaptiveLevelChanged();
+  void replaySave();
+  void replaySaved( QString destination, bool success );
+  void recoveryFinished( QString destination, bool success );
+  void jobsChanged();
+  void finalizeFinished( QString fileName, bool success );
   
   //void ShortcutPause();
   
@@ -227,6 +277,8 @@ private:
     QLabel * statusBarLabelFormat;
     QLabel * statusBarLabelAudio;
     QLabel * statusBarLabelFpsSettings;
+    QLabel * statusBarLabelSpeed;
+    QLabel * statusBarLabelDrop;
     QLabel * statusbarLabelScreenSize;
     QLabel * statusBarProgForRecord;
     
@@ -252,18 +304,56 @@ private:
     QxtGlobalShortcut *shortcutWebcam;
     QxtGlobalShortcut *shortcutMagnifier;
     QxtGlobalShortcut *shortcutPause;
+    QxtGlobalShortcut *shortcutReplay;
     QxtGlobalShortcut *shortcutStart;
     QxtGlobalShortcut *shortcutStop;
     
-    QTimer *windowMoveTimer;
+    QvkWindowWatcher *windowWatcher;
+    bool windowMovePaused;
     QDateTime beginTime;
 
     bool pause;
+    bool stopping;
     
     QFileSystemWatcher *VideoFileSystemWatcher;
     
     QvkFormatsAndCodecs *formatsAndCodecs;
+    QvkStartupTasks *startupTasks;
+    QTimer *recorderTimer;
+    QvkCaptureController *captureController;
+    QvkMultiSessionRecorder *screenRecorder;
+    QList<QRect> screenRects;
+    QStringList screenFiles;
+    QvkFileMover *fileMover;
+    QvkMergeJob *mergeJob;
+    QvkProgressParser *progressParser;
+    QvkMetricsHistory metricsHistory;
+    QvkSizeTracker *sizeTracker;
+    QvkBenchmark *benchmark;
+    QvkAdaptiveController *adaptive;
+    QvkReplayBuffer *replayBuffer;
+    bool replay;
+    QvkSegmentRotator *segmentRotator;
+    bool segmenting;
+    QvkRecovery *recovery;
+    bool preview;
+    QStringList previewArguments;
+    QvkMergeJob *previewMergeJob;
+    QvkFileMover *previewMover;
+    QvkJobQueue *jobQueue;
+    QvkDbus *vkDbus;
+    bool nativeCapture;
+    QDateTime nativePauseTime;
+    QStringList nativeCodecOptions;
+    int nativeThreads;
     QString getFfmpegVersionFullOutput();
+
+    static bool searchProgramm( QString ProgName );
+    static QString getPactlVersion();
+    static QString getXdgemailVersion();
+    static QString getLsofVersion();
+    static QVariant searchGIFPlayer();
+    static QVariant searchVideoPlayer();
     
     void makeAndSetValidIcon( int index );
 
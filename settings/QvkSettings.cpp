@@ -94,6 +94,24 @@ void QvkSettings::readAll()
       AudioCodec = settings.value( "Audiocodec", "libvorbis" ).toString();
       VideoContainer = settings.value( "Format", "mkv" ).toString();
       HideMouse = settings.value( "HideMouse").toUInt();
+      NativeCapture = settings.value( "NativeCapture", 0 ).toUInt();
+      VariableFrameRate = settings.value( "VariableFrameRate", 0 ).toUInt();
+      Threading = settings.value( "Threading", 0 ).toInt();
+      ReservedCores = settings.value( "ReservedCores", 1 ).toInt();
+      Adaptive = settings.value( "Adaptive", 0 ).toUInt();
+      Replay = settings.value( "Replay", 0 ).toUInt();
+      ReplaySeconds = settings.value( "ReplaySeconds", 60 ).toInt();
+      Segment = settings.value( "Segment", 0 ).toUInt();
+      SegmentMinutes = settings.value( "SegmentMinutes", 60 ).toInt();
+      SegmentSize = settings.value( "SegmentSize", 0 ).toInt();
+      Preview = settings.value( "Preview", 0 ).toUInt();
+      PreviewHeight = settings.value( "PreviewHeight", 720 ).toInt();
+      Transcode = settings.value( "Transcode", 0 ).toUInt();
+      TranscodeProfile = settings.value( "TranscodeProfile", "x264" ).toString();
+      FollowCursor = settings.value( "FollowCursor", 0 ).toUInt();
+      ScreenStreams = settings.value( "ScreenStreams", 0 ).toUInt();
+      ScreenStreamsMode = settings.value( "ScreenStreamsMode", 0 ).toUInt();
+      ScalePercent = settings.value( "ScalePercent", 100 ).toUInt();
     settings.endGroup();
 
     settings.beginGroup( "GUI" );
@@ -260,6 +278,96 @@ int QvkSettings::getHideMouse()
   return HideMouse; 
 }
 
+int QvkSettings::getNativeCapture()
+{
+  return NativeCapture;
+}
+
+int QvkSettings::getVariableFrameRate()
+{
+  return VariableFrameRate;
+}
+
+int QvkSettings::getThreading()
+{
+  return Threading;
+}
+
+int QvkSettings::getReservedCores()
+{
+  return ReservedCores;
+}
+
+int QvkSettings::getAdaptive()
+{
+  return Adaptive;
+}
+
+int QvkSettings::getReplay()
+{
+  return Replay;
+}
+
+int QvkSettings::getReplaySeconds()
+{
+  return ReplaySeconds;
+}
+
+int QvkSettings::getSegment()
+{
+  return Segment;
+}
+
+int QvkSettings::getSegmentMinutes()
+{
+  return SegmentMinutes;
+}
+
+int QvkSettings::getSegmentSize()
+{
+  return SegmentSize;
+}
+
+int QvkSettings::getPreview()
+{
+  return Preview;
+}
+
+int QvkSettings::getPreviewHeight()
+{
+  return PreviewHeight;
+}
+
+int QvkSettings::getTranscode()
+{
+  return Transcode;
+}
+
+QString QvkSettings::getTranscodeProfile()
+{
+  return TranscodeProfile;
+}
+
+int QvkSettings::getFollowCursor()
+{
+  return FollowCursor;
+}
+
+int QvkSettings::getScreenStreams()
+{
+  return ScreenStreams;
+}
+
+int QvkSettings::getScreenStreamsMode()
+{
+  return ScreenStreamsMode;
+}
+
+int QvkSettings::getScalePercent()
+{
+  return ScalePercent;
+}
+
 QString QvkSettings::getRecorder()
 {
   return Recorder;  
@@ -47,6 +47,24 @@ public:
   QString getAudioCodec();
   QString getVideoContainer();
   int getHideMouse();
+  int getNativeCapture();
+  int getVariableFrameRate();
+  int getThreading();
+  int getReservedCores();
+  int getAdaptive();
+  int getReplay();
+  int getReplaySeconds();
+  int getSegment();
+  int getSegmentMinutes();
+  int getSegmentSize();
+  int getPreview();
+  int getPreviewHeight();
+  int getTranscode();
+  QString getTranscodeProfile();
+  int getFollowCursor();
+  int getScreenStreams();
+  int getScreenStreamsMode();
+  int getScalePercent();
 
   // Gui
   int getX();
@@ -129,6 +147,24 @@ private:
   QString AudioCodec;
   QString VideoContainer;
   int HideMouse;
+  int NativeCapture;
+  int VariableFrameRate;
+  int Threading;
+  int ReservedCores;
+  int Adaptive;
+  int Replay;
+  int ReplaySeconds;
+  int Segment;
+  int SegmentMinutes;
+  int SegmentSize;
+  int Preview;
+  int PreviewHeight;
+  int Transcode;
+  QString TranscodeProfile;
+  int FollowCursor;
+  int ScreenStreams;
+  int ScreenStreamsMode;
+  int ScalePercent;
   QString Recorder;
   
   bool vokoscreenWithLibs;
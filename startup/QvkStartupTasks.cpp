@@ -0,0 +1,111 @@
+#include "QvkStartupTasks.h"
+
+#include <QDebug>
+#include <QtConcurrent/QtConcurrentRun>
+
+QvkStartupTasks::QvkStartupTasks()
+{
+}
+
+
+QvkStartupTasks::~QvkStartupTasks()
+{
+  QMapIterator<QString, Entry*> i( entries );
+  while ( i.hasNext() )
+  {
+    i.next();
+    i.value()->watcher->waitForFinished();
+    delete i.value();
+  }
+}
+
+
+void QvkStartupTasks::add( QString name, Task task )
+{
+  addLazy( name, task );
+  start( entries.value( name ) );
+}
+
+
+void QvkStartupTasks::addLazy( QString name, Task task )
+{
+  if ( entries.contains( name ) == true )
+  {
+    qDebug().noquote() << "[vokoscreen] [startup] task" << name << "already added";
+    return;
+  }
+
+  Entry *entry = new Entry;
+  entry->task = task;
+  entry->watcher = new QFutureWatcher<QVariant>( this );
+  entry->watcher->setObjectName( name );
+  entry->started = false;
+  entry->done = false;
+  connect( entry->watcher, SIGNAL( finished() ), this, SLOT( taskFinished() ) );
+  entries.insert( name, entry );
+}
+
+
+/**
+ * Starts a lazy task, finished() comes later
+ */
+void QvkStartupTasks::request( QString name )
+{
+  Entry *entry = entries.value( name );
+  if ( entry != NULL )
+    start( entry );
+}
+
+
+/**
+ * Waits for the task if it is not finished yet, a lazy task is started before.
+ * finished() is emitted before the result is returned.
+ */
+QVariant QvkStartupTasks::result( QString name )
+{
+  Entry *entry = entries.value( name );
+  if ( entry == NULL )
+    return QVariant();
+
+  if ( entry->done == false )
+  {
+    start( entry );
+    entry->watcher->waitForFinished();
+    complete( name, entry );
+  }
+  return entry->result;
+}
+
+
+bool QvkStartupTasks::isFinished( QString name )
+{
+  Entry *entry = entries.value( name );
+  return ( entry != NULL ) and ( entry->done == true );
+}
+
+
+void QvkStartupTasks::start( Entry *entry )
+{
+  if ( entry->started == true )
+    return;
+
+  entry->started = true;
+  entry->watcher->setFuture( QtConcurrent::run( entry->task ) );
+}
+
+
+void QvkStartupTasks::taskFinished()
+{
+  QString name = sender()->objectName();
+  Entry *entry = entries.value( name );
+  if ( ( entry != NULL ) and ( entry->done == false ) )
+    complete( name, entry );
+}
+
+
+void QvkStartupTasks::complete( QString name, Entry *entry )
+{
+  entry->done = true;
+  entry->result = entry->watcher->result();
+  emit finished( name, entry->result );
+}
@@ -0,0 +1,64 @@
+#ifndef QvkStartupTasks_H
+#define QvkStartupTasks_H
+
+#include <QObject>
+#include <QMap>
+#include <QVariant>
+#include <QFutureWatcher>
+
+#include <functional>
+
+/*
+ * Runs the probes of the startup, e.g. "pactl --version" or the search for players,
+ * in the thread pool so they do not block the window and each other.
+ *
+ * A task added with add() starts at once, one added with addLazy() not before
+ * request() or result() asks for it. finished() comes in the GUI thread,
+ * exactly once per task.
+ * A task runs in another thread, it must not touch widgets.
+ */
+class QvkStartupTasks: public QObject
+{
+    Q_OBJECT
+
+public:
+  typedef std::function<QVariant()> Task;
+
+  QvkStartupTasks();
+  virtual ~QvkStartupTasks();
+  void add( QString name, Task task );
+  void addLazy( QString name, Task task );
+  void request( QString name );
+  QVariant result( QString name );
+  bool isFinished( QString name );
+
+
+public slots:
+
+
+signals:
+  void finished( QString name, QVariant result );
+
+
+private slots:
+  void taskFinished();
+
+
+private:
+  struct Entry
+  {
+    Task task;
+    QFutureWatcher<QVariant> *watcher;
+    bool started;
+    bool done;
+    QVariant result;
+  };
+
+  void start( Entry *entry );
+  void complete( QString name, Entry *entry );
+
+  QMap<QString, Entry*> entries;
+
+};
+
+#endif
@@ -0,0 +1,7 @@
+QT          += concurrent
+
+INCLUDEPATH += $$PWD
+DEPENDPATH  += $$PWD
+HEADERS     += $$PWD/QvkStartupTasks.h
+
+SOURCES     += $$PWD/QvkStartupTasks.cpp
@@ -0,0 +1,164 @@
+#include "QvkAdaptiveController.h"
+#include "QvkBenchmark.h"
+
+#include <QDebug>
+
+static const double overloadSpeed = 0.95;
+static const double headroomSpeed = 1.3;
+static const qint64 overloadTime = 3000;  // ms
+static const qint64 headroomTime = 30000; // ms
+static const qint64 settleTime = 5000;    // ms
+static const qint64 restartDwell = 60000; // ms
+
+QvkAdaptiveController::QvkAdaptiveController()
+{
+  level = 0;
+  active = false;
+  lastChange = 0;
+  lastLevelChange = -1;
+  minimumDwell = 0;
+  overloadSince = -1;
+  headroomSince = -1;
+  lastDropFrames = 0;
+}
+
+
+QvkAdaptiveController::~QvkAdaptiveController()
+{
+}
+
+
+/**
+ * preset: the preset of the recording, the steps go from there to the fastest preset.
+ * withPreset: false if only the frame rate can be changed, e.g. for the native capture engine.
+ * With presets every change is a restart of ffmpeg.
+ */
+void QvkAdaptiveController::start( QString codec, QString preset, int frameRate, bool withPreset )
+{
+  levels.clear();
+
+  Level base;
+  base.preset = preset;
+  base.frameRate = frameRate;
+  levels << base;
+
+  if ( withPreset == true )
+  {
+    QStringList list = QvkBenchmark::presets( codec );
+    for ( int i = list.indexOf( preset ) - 1; i >= 0; i-- )
+    {
+      Level next = levels.last();
+      next.preset = list[ i ];
+      levels << next;
+    }
+  }
+
+  int rates[] = { frameRate * 3 / 4, frameRate / 2, frameRate / 3 };
+  for ( int i = 0; i < 3; i++ )
+  {
+    if ( ( rates[ i ] < 5 ) or ( rates[ i ] >= levels.last().frameRate ) )
+      continue;
+    Level next = levels.last();
+    next.frameRate = rates[ i ];
+    levels << next;
+  }
+
+  level = 0;
+  active = true;
+  lastDropFrames = 0;
+  overloadSince = -1;
+  headroomSince = -1;
+  clock.start();
+  lastChange = 0;
+  lastLevelChange = -1;
+  minimumDwell = withPreset ? restartDwell : 0;
+
+  qDebug().noquote() << "[vokoscreen] [adaptive] start with" << levels.count() << "levels, preset" << preset << frameRate << "fps";
+}
+
+
+void QvkAdaptiveController::stop()
+{
+  if ( active == false )
+    return;
+
+  active = false;
+  qDebug().noquote() << "[vokoscreen] [adaptive] stop at level" << level;
+}
+
+
+bool QvkAdaptiveController::isActive()
+{
+  return active;
+}
+
+
+QString QvkAdaptiveController::preset()
+{
+  return levels.isEmpty() ? "" : levels[ level ].preset;
+}
+
+
+int QvkAdaptiveController::frameRate()
+{
+  return levels.isEmpty() ? 0 : levels[ level ].frameRate;
+}
+
+
+/**
+ * Overload is a speed below realtime or dropped frames.
+ */
+void QvkAdaptiveController::update( QvkEncoderMetrics value )
+{
+  if ( active == false )
+    return;
+
+  qint64 now = clock.elapsed();
+  bool dropped = ( value.dropFrames > lastDropFrames );
+  lastDropFrames = value.dropFrames;
+
+  if ( now - lastChange < settleTime )
+    return;
+
+  // The overload and the headroom are counted, the step waits for the dwell
+  bool dwelled = ( lastLevelChange < 0 ) or ( now - lastLevelChange >= minimumDwell );
+
+  if ( ( value.speed < overloadSpeed ) or ( dropped == true ) )
+  {
+    headroomSince = -1;
+    if ( overloadSince < 0 )
+      overloadSince = now;
+
+    if ( ( now - overloadSince >= overloadTime ) and ( level + 1 < levels.count() ) and ( dwelled == true ) )
+      setLevel( level + 1, "speed " + QString::number( value.speed, 'f', 2 ) + "x, " + QString::number( value.dropFrames ) + " dropped" );
+  }
+  else if ( value.speed >= headroomSpeed )
+  {
+    overloadSince = -1;
+    if ( headroomSince < 0 )
+      headroomSince = now;
+
+    if ( ( now - headroomSince >= headroomTime ) and ( level > 0 ) and ( dwelled == true ) )
+      setLevel( level - 1, "speed " + QString::number( value.speed, 'f', 2 ) + "x" );
+  }
+  else
+  {
+    overloadSince = -1;
+    headroomSince = -1;
+  }
+}
+
+
+void QvkAdaptiveController::setLevel( int value, QString reason )
+{
+  qDebug().noquote() << "[vokoscreen] [adaptive]" << reason << "- step" << ( value > level ? "down" : "up" )
+                     << "to level" << value << "of" << levels.count() - 1 << ": preset" << levels[ value ].preset
+                     << levels[ value ].frameRate << "fps";
+  level = value;
+  lastChange = clock.elapsed();
+  lastLevelChange = lastChange;
+  lastDropFrames = 0; // A new ffmpeg process counts from zero
+  overloadSince = -1;
+  headroomSince = -1;
+  emit levelChanged();
+}
@@ -0,0 +1,69 @@
+#ifndef QvkAdaptiveController_H
+#define QvkAdaptiveController_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QElapsedTimer>
+
+#include "QvkEncoderMetrics.h"
+
+/*
+ * Watches the reports of the encoder and steps the quality down when the
+ * encoder can not keep up with realtime, and up again when there is headroom.
+ *
+ * The steps are: faster preset, then lower frame rate. The size stays,
+ * the fragments of the levels are joined with stream copy.
+ * A step down needs 3 s of overload, a step up 30 s of headroom. After a
+ * change the reports are ignored for some seconds, the encoder needs time
+ * to settle. If every change restarts the encoder a level is kept for at
+ * least a minute, every restart is a short gap in the recording.
+ */
+class QvkAdaptiveController: public QObject
+{
+    Q_OBJECT
+
+public:
+  QvkAdaptiveController();
+  virtual ~QvkAdaptiveController();
+
+  void start( QString codec, QString preset, int frameRate, bool withPreset );
+  void stop();
+  bool isActive();
+
+  QString preset();
+  int frameRate();
+
+
+public slots:
+  void update( QvkEncoderMetrics value );
+
+
+signals:
+  void levelChanged();
+
+
+private:
+  struct Level
+  {
+    QString preset;
+    int frameRate;
+  };
+
+  QVector<Level> levels;
+  int level;
+  bool active;
+  QElapsedTimer clock;
+  qint64 lastChange;
+  qint64 lastLevelChange;
+  qint64 minimumDwell;
+  qint64 overloadSince;
+  qint64 headroomSince;
+  qint64 lastDropFrames;
+
+  void setLevel( int value, QString reason );
+
+};
+
+#endif
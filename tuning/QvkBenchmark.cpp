@@ -0,0 +1,275 @@
+#include "QvkBenchmark.h"
+
+#include <QSettings>
+#include <QDebug>
+
+// A preset must be this much faster than realtime, the desktop needs also some cpu while recording
+static const double minimumSpeed = 1.3;
+
+QvkBenchmark::QvkBenchmark( QString progName )
+{
+  settingsName = progName;
+  codecIndex = 0;
+  presetIndex = 0;
+  step = 0;
+  steps = 0;
+  benchWidth = 0;
+  benchHeight = 0;
+  benchFrameRate = 0;
+  lastSpeed = 0;
+  stopped = false;
+
+  parser = new QvkProgressParser();
+  connect( parser, SIGNAL( metrics( QvkEncoderMetrics ) ), this, SLOT( metrics( QvkEncoderMetrics ) ) );
+
+  process = new QProcess( this );
+  connect( process, SIGNAL( readyReadStandardOutput() ), this, SLOT( readyReadStandardOutput() ) );
+  connect( process, SIGNAL( finished( int, QProcess::ExitStatus ) ), this, SLOT( processFinished( int, QProcess::ExitStatus ) ) );
+  connect( process, SIGNAL( error( QProcess::ProcessError ) ), this, SLOT( processError( QProcess::ProcessError ) ) );
+}
+
+
+QvkBenchmark::~QvkBenchmark()
+{
+  stop();
+  process->waitForFinished( 3000 );
+  delete parser;
+}
+
+
+bool QvkBenchmark::isRunning()
+{
+  return ( process->state() != QProcess::NotRunning );
+}
+
+
+/**
+ * Presets from fast to slow, empty if the codec has no presets
+ */
+QStringList QvkBenchmark::presets( QString codec )
+{
+  QStringList list;
+  if ( ( codec == "libx264" ) or ( codec == "libx264rgb" ) or ( codec == "libx265" ) )
+    list << "ultrafast" << "superfast" << "veryfast" << "faster" << "fast" << "medium";
+
+  // cpu-used of libvpx with -quality realtime, higher is faster
+  if ( codec == "libvpx" )
+    list << "16" << "8" << "4" << "2" << "0";
+
+  return list;
+}
+
+
+QStringList QvkBenchmark::presetArguments( QString codec, QString preset )
+{
+  QStringList list;
+  if ( preset.isEmpty() )
+    return list;
+
+  if ( ( codec == "libx264" ) or ( codec == "libx264rgb" ) or ( codec == "libx265" ) )
+    list << "-preset" << preset;
+
+  if ( codec == "libvpx" )
+    list << "-cpu-used" << preset;
+
+  return list;
+}
+
+
+/**
+ * The speed scales with the pixel rate, a benchmark with the full screen is also valid for an area.
+ * Empty if there is no benchmark for the codec.
+ */
+QString QvkBenchmark::bestPreset( QString codec, int width, int height, int frameRate )
+{
+  QSettings settings( settingsName, settingsName );
+  settings.beginGroup( "Benchmark" );
+  settings.beginGroup( codec );
+
+  double benchPixelRate = settings.value( "PixelRate", 0 ).toDouble();
+  double pixelRate = (double)width * height * qMax( 1, frameRate );
+  QStringList list = presets( codec );
+  if ( ( benchPixelRate <= 0 ) or ( pixelRate <= 0 ) or list.isEmpty() or ( settings.contains( list.first() ) == false ) )
+    return "";
+
+  // If no preset is fast enough the fastest is taken
+  QString best = list.first();
+  for ( int i = 0; i < list.count(); i++ )
+  {
+    if ( settings.contains( list[ i ] ) == false )
+      break;
+
+    double speed = settings.value( list[ i ] ).toDouble() * benchPixelRate / pixelRate;
+    if ( speed < minimumSpeed )
+      break;
+
+    best = list[ i ];
+  }
+
+  return best;
+}
+
+
+void QvkBenchmark::start( QString program, QStringList codecs, int width, int height, int frameRate, QvkThreadPolicy policy )
+{
+  if ( isRunning() )
+    return;
+
+  ffmpegProgram = program;
+  threadPolicy = policy;
+  benchWidth = width - width % 2;
+  benchHeight = height - height % 2;
+  benchFrameRate = qMax( 1, frameRate );
+
+  codecList.clear();
+  steps = 0;
+  for ( int i = 0; i < codecs.count(); i++ )
+  {
+    if ( codecs[ i ] == "gif" )
+      continue;
+    codecList << codecs[ i ];
+    steps += qMax( 1, presets( codecs[ i ] ).count() );
+  }
+
+  codecIndex = 0;
+  presetIndex = 0;
+  step = 0;
+  stopped = false;
+
+  if ( codecList.isEmpty() )
+  {
+    emit finished();
+    return;
+  }
+
+  qDebug().noquote() << "[vokoscreen] [benchmark] start" << codecList.join( " " ) << benchWidth << "x" << benchHeight << benchFrameRate << "fps";
+  runOne();
+}
+
+
+void QvkBenchmark::stop()
+{
+  if ( isRunning() == false )
+    return;
+
+  stopped = true;
+  process->kill();
+}
+
+
+void QvkBenchmark::runOne()
+{
+  QString codec = codecList[ codecIndex ];
+  presetList = presets( codec );
+  if ( presetList.isEmpty() )
+    presetList << "";
+  QString preset = presetList[ presetIndex ];
+
+  QStringList arguments;
+  arguments << "-nostats" << "-progress" << "pipe:1";
+  arguments << "-f" << "lavfi";
+  arguments << "-i" << "testsrc2=size=" + QString::number( benchWidth ) + "x" + QString::number( benchHeight )
+                       + ":rate=" + QString::number( benchFrameRate );
+  arguments << "-t" << "3";
+  arguments << "-pix_fmt" << ( codec == "libx264rgb" ? "rgb24" : "yuv420p" );
+  arguments << "-c:v" << codec;
+  if ( codec == "libvpx" )
+    arguments << "-quality" << "realtime" << "-b:v" << "2M";
+  arguments << presetArguments( codec, preset );
+  arguments << threadPolicy.codecOptions( codec );
+  arguments << "-f" << "null" << "-";
+
+  step++;
+  emit progress( codec, preset, step, steps );
+
+  lastSpeed = 0;
+  parser->reset();
+  process->start( ffmpegProgram, arguments );
+}
+
+
+void QvkBenchmark::readyReadStandardOutput()
+{
+  parser->feed( process->readAllStandardOutput() );
+}
+
+
+void QvkBenchmark::metrics( QvkEncoderMetrics value )
+{
+  if ( value.speed > 0 )
+    lastSpeed = value.speed;
+}
+
+
+void QvkBenchmark::processFinished( int exitCode, QProcess::ExitStatus exitStatus )
+{
+  if ( stopped == true )
+  {
+    qDebug().noquote() << "[vokoscreen] [benchmark] stopped";
+    emit finished();
+    return;
+  }
+
+  QString codec = codecList[ codecIndex ];
+  QString preset = presetList[ presetIndex ];
+  bool ok = ( exitStatus == QProcess::NormalExit ) and ( exitCode == 0 ) and ( lastSpeed > 0 );
+  if ( ok == true )
+  {
+    qDebug().noquote() << "[vokoscreen] [benchmark]" << codec << preset << QString::number( lastSpeed, 'f', 2 ) + "x";
+    saveResult( codec, preset, lastSpeed );
+    emit result( codec, preset, lastSpeed );
+  }
+  else
+  {
+    qDebug().noquote() << "[vokoscreen] [benchmark]" << codec << preset << "failed";
+  }
+
+  // The next presets are slower, if this one is too slow they are not tried
+  presetIndex++;
+  if ( ( ok == false ) or ( lastSpeed < minimumSpeed ) or ( presetIndex >= presetList.count() ) )
+  {
+    step += presetList.count() - presetIndex;
+    codecIndex++;
+    presetIndex = 0;
+  }
+
+  if ( codecIndex >= codecList.count() )
+  {
+    qDebug().noquote() << "[vokoscreen] [benchmark] finished";
+    emit finished();
+    return;
+  }
+
+  runOne();
+}
+
+
+/**
+ * A recorder that can not be started gives no finished(), the other codecs would fail the same way
+ */
+void QvkBenchmark::processError( QProcess::ProcessError value )
+{
+  if ( value != QProcess::FailedToStart )
+    return;
+
+  qDebug().noquote() << "[vokoscreen] [benchmark] can not start" << ffmpegProgram << process->errorString();
+  emit finished();
+  emit error( tr( "Benchmark failed, can not start" ) + " " + ffmpegProgram );
+}
+
+
+/**
+ * The old results of a codec are removed with the first new result
+ */
+void QvkBenchmark::saveResult( QString codec, QString preset, double speed )
+{
+  QSettings settings( settingsName, settingsName );
+  settings.beginGroup( "Benchmark" );
+  settings.beginGroup( codec );
+  if ( presetIndex == 0 )
+    settings.remove( "" );
+  settings.setValue( "PixelRate", (double)benchWidth * benchHeight * benchFrameRate );
+  settings.setValue( preset.isEmpty() ? "default" : preset, speed );
+  settings.endGroup();
+  settings.endGroup();
+}
@@ -0,0 +1,77 @@
+#ifndef QvkBenchmark_H
+#define QvkBenchmark_H
+
+#include <QObject>
+#include <QProcess>
+#include <QString>
+#include <QStringList>
+
+#include "QvkProgressParser.h"
+#include "QvkThreadPolicy.h"
+
+/*
+ * Encodes a synthetic clip (lavfi testsrc2) with every codec at several presets
+ * and measures the speed against realtime. The speeds are saved in the group
+ * Benchmark of the settings together with the pixel rate of the clip.
+ *
+ * bestPreset() scales the measured speed to the pixel rate of the recording and
+ * gives the slowest preset that is still comfortably faster than realtime.
+ */
+class QvkBenchmark: public QObject
+{
+    Q_OBJECT
+
+public:
+  QvkBenchmark( QString progName );
+  virtual ~QvkBenchmark();
+
+  bool isRunning();
+
+  static QStringList presets( QString codec );
+  static QStringList presetArguments( QString codec, QString preset );
+  QString bestPreset( QString codec, int width, int height, int frameRate );
+  void start( QString program, QStringList codecs, int width, int height, int frameRate, QvkThreadPolicy policy );
+
+
+public slots:
+  void stop();
+
+
+signals:
+  void progress( QString codec, QString preset, int step, int steps );
+  void result( QString codec, QString preset, double speed );
+  void finished();
+  void error( QString message );
+
+
+private slots:
+  void processFinished( int exitCode, QProcess::ExitStatus exitStatus );
+  void processError( QProcess::ProcessError value );
+  void readyReadStandardOutput();
+  void metrics( QvkEncoderMetrics value );
+
+
+private:
+  QString settingsName;
+  QProcess *process;
+  QvkProgressParser *parser;
+  QvkThreadPolicy threadPolicy;
+  QString ffmpegProgram;
+  QStringList codecList;
+  QStringList presetList;
+  int codecIndex;
+  int presetIndex;
+  int step;
+  int steps;
+  int benchWidth;
+  int benchHeight;
+  int benchFrameRate;
+  double lastSpeed;
+  bool stopped;
+
+  void runOne();
+  void saveResult( QString codec, QString preset, double speed );
+
+};
+
+#endif
@@ -0,0 +1,81 @@
+#include "QvkThreadPolicy.h"
+
+#include <thread>
+
+QvkThreadPolicy::QvkThreadPolicy( int threading, int reservedCores )
+{
+  threadingMode = threading;
+  reserved = qMax( 0, reservedCores );
+}
+
+
+QvkThreadPolicy::~QvkThreadPolicy()
+{
+}
+
+
+/**
+ * hardware_concurrency() may return 0 if it is not known
+ */
+int QvkThreadPolicy::cores()
+{
+  return qMax( 1, (int)std::thread::hardware_concurrency() );
+}
+
+
+/**
+ * Most encoders of ffmpeg do not use more than 16 threads, libvpx gains nothing above 8.
+ */
+int QvkThreadPolicy::threads( QString codec )
+{
+  int value = qMax( 1, cores() - reserved );
+
+  if ( codec == "gif" )
+    return 1;
+
+  if ( codec == "libvpx" )
+    return qMin( value, 8 );
+
+  if ( ( codec == "libx264" ) or ( codec == "libx264rgb" ) or ( codec == "libx265" ) )
+    return value;
+
+  return qMin( value, 16 );
+}
+
+
+/**
+ * Empty if the codec decides itself, libvpx and libx265 have their own threading
+ */
+QString QvkThreadPolicy::threadType( QString codec )
+{
+  if ( ( codec == "libvpx" ) or ( codec == "libx265" ) or ( codec == "gif" ) )
+    return "";
+
+  if ( threadingMode == Frame )
+    return "frame";
+
+  if ( threadingMode == Slice )
+    return "slice";
+
+  if ( ( codec == "libx264" ) or ( codec == "libx264rgb" ) )
+    return "frame";
+
+  return "slice";
+}
+
+
+/**
+ * The options in the form of the ffmpeg command line, also understood by the native capture engine
+ */
+QStringList QvkThreadPolicy::codecOptions( QString codec )
+{
+  QStringList options;
+  options << "-threads" << QString::number( threads( codec ) );
+
+  QString type = threadType( codec );
+  // The libx264 wrapper turns thread_type slice into sliced-threads
+  if ( type > "" )
+    options << "-thread_type" << type;
+
+  return options;
+}
@@ -0,0 +1,36 @@
+#ifndef QvkThreadPolicy_H
+#define QvkThreadPolicy_H
+
+#include <QString>
+#include <QStringList>
+
+/*
+ * How many threads the encoder gets and how they are used.
+ *
+ * The cores of the computer minus the reserved cores are used, the reserved
+ * cores are left for the X server, the compositor and the capture.
+ * With Auto the threading type is chosen per codec: frame threading for
+ * x264, it compresses better than sliced threads, slice threading for the
+ * codecs of ffmpeg that have no frame threading in the encoder.
+ */
+class QvkThreadPolicy
+{
+public:
+  enum Threading { Auto = 0, Frame = 1, Slice = 2 };
+
+  QvkThreadPolicy( int threading = Auto, int reservedCores = 1 );
+  virtual ~QvkThreadPolicy();
+
+  static int cores();
+
+  int threads( QString codec );
+  QString threadType( QString codec );
+  QStringList codecOptions( QString codec );
+
+private:
+  int threadingMode;
+  int reserved;
+
+};
+
+#endif
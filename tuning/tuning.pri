@@ -0,0 +1,9 @@
+INCLUDEPATH += $$PWD
+DEPENDPATH  += $$PWD
+HEADERS     += $$PWD/QvkThreadPolicy.h \
+               $$PWD/QvkBenchmark.h \
+               $$PWD/QvkAdaptiveController.h
+
+SOURCES     += $$PWD/QvkThreadPolicy.cpp \
+               $$PWD/QvkBenchmark.cpp \
+               $$PWD/QvkAdaptiveController.cpp
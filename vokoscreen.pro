@@ -123,6 +123,33 @@ include(dbus/dbus.pri)
 # allLoaded
 include(allLoaded/allLoaded.pri )
 
+# capture
+include(capture/capture.pri)
+
+# finalize
+include(finalize/finalize.pri)
+
+# progress
+include(progress/progress.pri)
+
+# tuning
+include(tuning/tuning.pri)
+
+# replay
+include(replay/replay.pri)
+
+# recovery
+include(recovery/recovery.pri)
+
+# jobs
+include(jobs/jobs.pri)
+
+# headless
+include(headless/headless.pri)
+
+# startup
+include(startup/startup.pri)
+
 QT += core gui widgets x11extras network testlib dbus multimedia multimediawidgets
 
 DBUS_ADAPTORS += vokoscreenQvKDbus.xml
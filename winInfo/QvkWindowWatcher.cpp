@@ -0,0 +1,210 @@
+#include "QvkWindowWatcher.h"
+
+#include <QCoreApplication>
+#include <QX11Info>
+#include <QDebug>
+
+#include <X11/Xlib.h>
+#include <xcb/xcb.h>
+
+QvkWindowWatcher::QvkWindowWatcher()
+{
+  window = 0;
+  frame = 0;
+  windowMask = 0;
+  frameMask = 0;
+  moving = false;
+  lastX = 0;
+  lastY = 0;
+
+  settleTimer = new QTimer( this );
+  settleTimer->setSingleShot( true );
+  settleTimer->setInterval( 300 );
+  connect( settleTimer, SIGNAL( timeout() ), this, SLOT( settle() ) );
+
+  QCoreApplication::instance()->installNativeEventFilter( this );
+}
+
+
+QvkWindowWatcher::~QvkWindowWatcher()
+{
+  QCoreApplication::instance()->removeNativeEventFilter( this );
+  release();
+}
+
+
+/**
+ * The top level window of the window manager that holds the window,
+ * the window itself if there is no window manager that reparents.
+ */
+WId QvkWindowWatcher::findFrame( WId value )
+{
+  Display *display = QX11Info::display();
+  Window root, parent, *children;
+  unsigned int count;
+  Window current = value;
+  while ( XQueryTree( display, current, &root, &parent, &children, &count ) != 0 )
+  {
+    if ( children != NULL )
+      XFree( children );
+    if ( ( parent == root ) or ( parent == 0 ) )
+      return current;
+    current = parent;
+  }
+  return value;
+}
+
+
+/**
+ * The event mask is per client and window, the mask that was set before is given back
+ */
+long QvkWindowWatcher::selectInput( WId value )
+{
+  XWindowAttributes attributes;
+  if ( XGetWindowAttributes( QX11Info::display(), value, &attributes ) == 0 )
+    return 0;
+
+  XSelectInput( QX11Info::display(), value, attributes.your_event_mask | StructureNotifyMask );
+  return attributes.your_event_mask;
+}
+
+
+void QvkWindowWatcher::watch( WId value )
+{
+  release();
+
+  // A window that is already destroyed is not watched
+  WId frameValue = findFrame( value );
+  XWindowAttributes attributes;
+  if ( ( XGetWindowAttributes( QX11Info::display(), value, &attributes ) == 0 ) or
+       ( XGetWindowAttributes( QX11Info::display(), frameValue, &attributes ) == 0 ) )
+  {
+    qDebug().noquote() << "[vokoscreen] [window] can not watch" << QString::number( value, 16 );
+    return;
+  }
+  lastX = attributes.x;
+  lastY = attributes.y;
+
+  window = value;
+  frame = frameValue;
+  windowMask = selectInput( window );
+  if ( frame != window )
+    frameMask = selectInput( frame );
+  XFlush( QX11Info::display() );
+
+  qDebug().noquote() << "[vokoscreen] [window] watch" << QString::number( window, 16 ) << "frame" << QString::number( frame, 16 );
+}
+
+
+void QvkWindowWatcher::release()
+{
+  settleTimer->stop();
+  moving = false;
+
+  if ( window == 0 )
+    return;
+
+  XSelectInput( QX11Info::display(), window, windowMask );
+  if ( frame != window )
+    XSelectInput( QX11Info::display(), frame, frameMask );
+  XFlush( QX11Info::display() );
+
+  window = 0;
+  frame = 0;
+}
+
+
+/**
+ * x, y: position of the frame on the screen.
+ * A ConfigureNotify also comes on restacking, then nothing has moved.
+ */
+void QvkWindowWatcher::configured( int x, int y )
+{
+  if ( ( x == lastX ) and ( y == lastY ) )
+    return;
+
+  lastX = x;
+  lastY = y;
+
+  if ( moving == false )
+  {
+    moving = true;
+    emit moveStarted();
+  }
+
+  emit moved();
+  settleTimer->start();
+}
+
+
+/**
+ * The window rests, but while a mouse button is held the user may drag it further.
+ */
+void QvkWindowWatcher::settle()
+{
+  if ( window == 0 )
+    return;
+
+  Window root, child;
+  int rootX, rootY, winX, winY;
+  unsigned int mask;
+  XQueryPointer( QX11Info::display(), frame, &root, &child, &rootX, &rootY, &winX, &winY, &mask );
+  if ( mask & ( Button1Mask | Button2Mask | Button3Mask ) )
+  {
+    settleTimer->start();
+    return;
+  }
+
+  moving = false;
+  emit moveFinished();
+}
+
+
+/**
+ * Synthetic ConfigureNotify events of the window manager are not used, they have
+ * root coordinates while the real ones are relative to the parent.
+ */
+bool QvkWindowWatcher::nativeEventFilter( const QByteArray &eventType, void *message, long *result )
+{
+  Q_UNUSED( result );
+
+  if ( ( window == 0 ) or ( eventType != "xcb_generic_event_t" ) )
+    return false;
+
+  xcb_generic_event_t *event = static_cast<xcb_generic_event_t *>( message );
+  bool synthetic = ( event->response_type & 0x80 );
+
+  switch ( event->response_type & ~0x80 )
+  {
+    case XCB_CONFIGURE_NOTIFY:
+    {
+      xcb_configure_notify_event_t *configure = (xcb_configure_notify_event_t *)event;
+      if ( ( synthetic == false ) and ( configure->window == frame ) )
+        configured( configure->x, configure->y );
+      break;
+    }
+    case XCB_REPARENT_NOTIFY:
+    {
+      // E.g. the window manager was restarted
+      xcb_reparent_notify_event_t *reparent = (xcb_reparent_notify_event_t *)event;
+      if ( reparent->window == window )
+        watch( window );
+      break;
+    }
+    case XCB_DESTROY_NOTIFY:
+    {
+      xcb_destroy_notify_event_t *destroy = (xcb_destroy_notify_event_t *)event;
+      if ( destroy->window == window )
+      {
+        qDebug().noquote() << "[vokoscreen] [window] closed" << QString::number( window, 16 );
+        settleTimer->stop();
+        window = 0;
+        frame = 0;
+        emit closed();
+      }
+      break;
+    }
+  }
+
+  return false;
+}
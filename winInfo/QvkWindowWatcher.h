@@ -0,0 +1,61 @@
+#ifndef QvkWindowWatcher_H
+#define QvkWindowWatcher_H
+
+#include <QObject>
+#include <QTimer>
+#include <QWidget>
+#include <QAbstractNativeEventFilter>
+
+/*
+ * Watches the recorded window with StructureNotify events of the X server
+ * instead of asking for its geometry again and again.
+ *
+ * The events of the window and of the frame of the window manager come
+ * through the event loop of Qt. A move is reported once at the begin, with
+ * every new position and once at the end, when the window has not moved for
+ * a moment and no mouse button is held anymore.
+ */
+class QvkWindowWatcher: public QObject, public QAbstractNativeEventFilter
+{
+    Q_OBJECT
+
+public:
+  QvkWindowWatcher();
+  virtual ~QvkWindowWatcher();
+
+  bool nativeEventFilter( const QByteArray &eventType, void *message, long *result );
+
+
+public slots:
+  void watch( WId value );
+  void release();
+
+
+signals:
+  void moveStarted();
+  void moved();
+  void moveFinished();
+  void closed();
+
+
+private slots:
+  void settle();
+
+
+private:
+  WId window;
+  WId frame;
+  long windowMask;
+  long frameMask;
+  QTimer *settleTimer;
+  bool moving;
+  int lastX;
+  int lastY;
+
+  WId findFrame( WId value );
+  long selectInput( WId value );
+  void configured( int x, int y );
+
+};
+
+#endif
@@ -1,5 +1,7 @@
 INCLUDEPATH += $$PWD
 DEPENDPATH  += $$PWD
-HEADERS     += $$PWD/QvkWinInfo.h
+HEADERS     += $$PWD/QvkWinInfo.h \
+               $$PWD/QvkWindowWatcher.h
                    
-SOURCES     += $$PWD/QvkWinInfo.cpp
+SOURCES     += $$PWD/QvkWinInfo.cpp \
+               $$PWD/QvkWindowWatcher.cpp